@@ -0,0 +1,61 @@
+#ifndef OPENGL_GAMEENGINE_ALLOCATIONCOUNTER_HPP
+#define OPENGL_GAMEENGINE_ALLOCATIONCOUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Heap allocations the process made through operator new. The source file that includes this header with
+// ENGINE_ALLOCATION_COUNTING defined replaces the global operator new and delete, so the definition is set for a
+// single file of an executable. Without it the count stays 0.
+class AllocationCounter
+{
+public:
+    static long GetCount() { return _count.load(std::memory_order_relaxed); }
+
+    static void Add() { _count.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    inline static std::atomic<long> _count{0};
+};
+
+#ifdef ENGINE_ALLOCATION_COUNTING
+
+void* operator new(std::size_t size)
+{
+    AllocationCounter::Add();
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+// Over-allocates and keeps the malloc pointer in front of the aligned block, aligned_alloc is missing on MSVC
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::Add();
+    std::size_t align = (std::size_t)alignment;
+    void* memory = std::malloc(size + align + sizeof(void*));
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    std::uintptr_t aligned = ((std::uintptr_t)memory + sizeof(void*) + align - 1) & ~(std::uintptr_t)(align - 1);
+    ((void**)aligned)[-1] = memory;
+    return (void*)aligned;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { if (memory != nullptr) std::free(((void**)memory)[-1]); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { if (memory != nullptr) std::free(((void**)memory)[-1]); }
+void operator delete[](void* memory, std::align_val_t) noexcept { if (memory != nullptr) std::free(((void**)memory)[-1]); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { if (memory != nullptr) std::free(((void**)memory)[-1]); }
+
+#endif
+
+#endif //OPENGL_GAMEENGINE_ALLOCATIONCOUNTER_HPP
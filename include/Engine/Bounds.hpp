@@ -0,0 +1,189 @@
+#ifndef OPENGL_GAMEENGINE_BOUNDS_HPP
+#define OPENGL_GAMEENGINE_BOUNDS_HPP
+
+#include <glm/glm.hpp>
+#include <limits>
+#include <algorithm>
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    AABB() = default;
+    AABB(glm::vec3 min, glm::vec3 max) : min(min), max(max) {};
+
+    bool IsValid() const
+    {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+    float GetSurfaceArea() const
+    {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    void Extend(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void Extend(const AABB& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    AABB Expanded(float margin) const
+    {
+        return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+    }
+
+    // The volume covered when the box is moved by offset
+    AABB Swept(const glm::vec3& offset) const
+    {
+        return AABB(glm::min(min, min + offset), glm::max(max, max + offset));
+    }
+
+    bool Contains(const AABB& other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    bool Intersects(const AABB& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    // Bounds of the box after an affine transformation (Arvo's method)
+    AABB Transformed(const glm::mat4& matrix) const
+    {
+        glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+        glm::vec3 extents = GetExtents();
+        glm::vec3 newExtents = glm::abs(glm::vec3(matrix[0])) * extents.x +
+                               glm::abs(glm::vec3(matrix[1])) * extents.y +
+                               glm::abs(glm::vec3(matrix[2])) * extents.z;
+        return AABB(center - newExtents, center + newExtents);
+    }
+
+    static AABB Merge(const AABB& a, const AABB& b)
+    {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+};
+
+struct Sphere
+{
+    glm::vec3 center;
+    float radius;
+
+    bool Intersects(const AABB& box) const
+    {
+        glm::vec3 closest = glm::clamp(center, box.min, box.max);
+        glm::vec3 offset = closest - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+};
+
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    // Slab test, returns the entry distance along the ray or a negative value on a miss
+    float Intersect(const AABB& box, float maxDistance = std::numeric_limits<float>::max()) const
+    {
+        glm::vec3 invDirection = 1.0f / direction;
+        glm::vec3 t0 = (box.min - origin) * invDirection;
+        glm::vec3 t1 = (box.max - origin) * invDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        return entry <= exit ? entry : -1.0f;
+    }
+};
+
+enum class FrustumTest
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE
+};
+
+class Frustum
+{
+public:
+    enum Plane { LEFT_PLANE, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+    static constexpr unsigned int ALL_PLANES = (1u << PLANE_COUNT) - 1u;
+
+    Frustum() = default;
+
+    // Extracts the clip planes from a view-projection matrix (Gribb-Hartmann)
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        glm::vec4 row0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        planes[LEFT_PLANE] = row3 + row0;
+        planes[RIGHT_PLANE] = row3 - row0;
+        planes[BOTTOM_PLANE] = row3 + row1;
+        planes[TOP_PLANE] = row3 - row1;
+        planes[NEAR_PLANE] = row3 + row2;
+        planes[FAR_PLANE] = row3 - row2;
+
+        for (auto& plane : planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    // Tests the box against the planes set in planeMask, clearing the bits of planes the box is fully inside of
+    FrustumTest Test(const AABB& box, unsigned int& planeMask) const
+    {
+        glm::vec3 center = box.GetCenter();
+        glm::vec3 extents = box.GetExtents();
+        for (int i = 0; i < PLANE_COUNT; i++)
+        {
+            unsigned int bit = 1u << i;
+            if (!(planeMask & bit))
+                continue;
+
+            glm::vec3 normal = glm::vec3(planes[i]);
+            float distance = glm::dot(normal, center) + planes[i].w;
+            float radius = glm::dot(glm::abs(normal), extents);
+            if (distance + radius < 0.0f)
+                return FrustumTest::OUTSIDE;
+            if (distance - radius >= 0.0f)
+                planeMask &= ~bit;
+        }
+        return planeMask == 0 ? FrustumTest::INSIDE : FrustumTest::INTERSECTS;
+    }
+
+    bool Intersects(const AABB& box) const
+    {
+        unsigned int planeMask = activePlanes;
+        return Test(box, planeMask) != FrustumTest::OUTSIDE;
+    }
+
+    // Leaves the plane out of Intersects and spatial queries, the volume becomes open on that side
+    void RemovePlane(Plane plane)
+    {
+        activePlanes &= ~(1u << plane);
+    }
+
+    glm::vec4 planes[PLANE_COUNT];
+    unsigned int activePlanes = ALL_PLANES;
+};
+
+#endif //OPENGL_GAMEENGINE_BOUNDS_HPP
@@ -0,0 +1,71 @@
+#ifndef OPENGL_GAMEENGINE_CAMERAPATH_HPP
+#define OPENGL_GAMEENGINE_CAMERAPATH_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "Engine/camera.hpp"
+
+// Looping camera flight through key points, positions and look at targets follow Catmull-Rom splines.
+// Scripted paths make benchmark runs see the same frames every time.
+class CameraPath
+{
+public:
+    struct Key
+    {
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+
+    CameraPath() = default;
+    explicit CameraPath(const std::vector<Key>& keys) : keys(keys) {}
+
+    // Circle around center, bobbing between two heights so the view sweeps over near and far objects
+    static CameraPath Orbit(glm::vec3 center, float radius, float minHeight, float maxHeight, int keyCount = 8)
+    {
+        std::vector<Key> keys;
+        for (int i = 0; i < keyCount; i++)
+        {
+            float angle = 2.0f * glm::pi<float>() * i / keyCount;
+            float height = i % 2 == 0 ? minHeight : maxHeight;
+            keys.push_back({center + glm::vec3(std::cos(angle) * radius, height, std::sin(angle) * radius), center});
+        }
+        return CameraPath(keys);
+    }
+
+    void AddKey(const Key& key) { keys.push_back(key); }
+    int GetKeyCount() const { return (int)keys.size(); }
+
+    // Places the camera at t in [0, 1) of the loop
+    void Apply(Camera& camera, float t) const
+    {
+        if (keys.empty())
+            return;
+
+        int count = (int)keys.size();
+        float segment = (t - std::floor(t)) * count;
+        int i = std::min((int)segment, count - 1);
+        float local = segment - i;
+
+        const Key& k0 = keys[(i - 1 + count) % count];
+        const Key& k1 = keys[i];
+        const Key& k2 = keys[(i + 1) % count];
+        const Key& k3 = keys[(i + 2) % count];
+        camera.position = CatmullRom(k0.position, k1.position, k2.position, k3.position, local);
+        camera.lookAt(CatmullRom(k0.target, k1.target, k2.target, k3.target, local));
+    }
+
+private:
+    static glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+    {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+    }
+
+    std::vector<Key> keys;
+};
+
+#endif //OPENGL_GAMEENGINE_CAMERAPATH_HPP
@@ -0,0 +1,260 @@
+#ifndef OPENGL_GAMEENGINE_CASCADEDSHADOWMAP_HPP
+#define OPENGL_GAMEENGINE_CASCADEDSHADOWMAP_HPP
+
+#include <glad/glad.h>
+#include <cmath>
+#include "Engine/Log.hpp"
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Engine/shader.hpp"
+#include "Engine/Bounds.hpp"
+
+// Directional light shadow split into cascades along the view frustum.
+// Every cascade is a layer of one depth texture array and all of them are rendered in a single pass
+// by the layered shadow shader. Far cascades can be refreshed at a lower rate.
+// Static casters are kept in a second texture array that is only redrawn when a cascade is refitted,
+// the light or a static object changes; each frame it is copied into the shadow map and the dynamic
+// casters are drawn on top.
+class CascadedShadowMap
+{
+public:
+    static constexpr int MAX_CASCADES = 4;
+
+    unsigned int ID;
+    unsigned int shadowMap;
+    unsigned int staticID;
+    unsigned int staticShadowMap;
+
+    CascadedShadowMap(int resolution, glm::vec3 lightDirection, int cascadeCount, float shadowDistance, float splitLambda = 0.75f)
+    {
+        this->resolution = resolution;
+        this->cascadeCount = std::clamp(cascadeCount, 1, MAX_CASCADES);
+        this->shadowDistance = shadowDistance;
+        this->splitLambda = splitLambda;
+        SetLightDirection(lightDirection);
+        for (int i = 0; i < MAX_CASCADES; i++)
+            updateIntervals[i] = 1 << std::max(0, i - 1);
+
+        CreateLayers(ID, shadowMap);
+        CreateLayers(staticID, staticShadowMap);
+    }
+
+    // Cascade i is redrawn every frames-th frame, cascades with the same interval are staggered
+    void SetUpdateInterval(int cascade, int frames)
+    {
+        updateIntervals[cascade] = std::max(1, frames);
+    }
+
+    void SetLightDirection(glm::vec3 direction)
+    {
+        lightDirection = glm::normalize(direction);
+        // Keep the light view stable, only switch the up vector when it would be parallel to the light
+        lightUp = std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        forceUpdate = true;
+    }
+
+    // Splits the camera frustum and refits the cascades that are due this frame.
+    // staticVersion changes whenever a static caster was added, moved or removed.
+    // Returns the mask of cascades that have to be rendered.
+    unsigned int Update(const glm::mat4& view, float fovRadians, float aspect, float nearPlane, unsigned long staticVersion)
+    {
+        if (staticVersion != cachedStaticVersion || forceUpdate)
+        {
+            staticDirtyMask = (1u << cascadeCount) - 1u;
+            cachedStaticVersion = staticVersion;
+        }
+
+        float farPlane = nearPlane + shadowDistance;
+        updateMask = 0;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            // Practical split scheme, blend of logarithmic and uniform splits
+            float ratio = (float)(i + 1) / (float)cascadeCount;
+            float logSplit = nearPlane * std::pow(farPlane / nearPlane, ratio);
+            float uniformSplit = nearPlane + (farPlane - nearPlane) * ratio;
+            float split = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+            bool due = forceUpdate || (frameIndex + i) % updateIntervals[i] == 0;
+            if (due)
+            {
+                float sliceNear = i == 0 ? nearPlane : cascadeSplits[i - 1];
+                if (FitCascade(i, view, fovRadians, aspect, sliceNear, split))
+                    staticDirtyMask |= 1u << i;
+                updateMask |= 1u << i;
+            }
+            cascadeSplits[i] = split;
+        }
+        forceUpdate = false;
+        frameIndex++;
+
+        // Static layers of cascades that are not due stay dirty until their next update
+        staticUpdateMask = staticDirtyMask & updateMask;
+        staticDirtyMask &= ~updateMask;
+        return updateMask;
+    }
+
+    unsigned int GetUpdateMask() const { return updateMask; }
+    unsigned int GetStaticUpdateMask() const { return staticUpdateMask; }
+    int GetCascadeCount() const { return cascadeCount; }
+    glm::vec3 GetLightDirection() const { return lightDirection; }
+    glm::vec2 GetSize() const { return glm::vec2(resolution, resolution); }
+
+    // Light volume of the cascade open towards the light, casters in front of it are drawn with depth clamping
+    const Frustum& GetCasterFrustum(int cascade) const { return casterFrustums[cascade]; }
+    float GetShadowDistance(int cascade) const { return cascadeDepths[cascade]; }
+
+    // Clears the static layers that are redrawn this frame
+    void ClearStaticCascades()
+    {
+        float clearDepth = 1.0f;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            if (staticUpdateMask & (1u << i))
+                glClearTexSubImage(staticShadowMap, 0, 0, 0, i, resolution, resolution, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+        }
+    }
+
+    // Starts the layers that are redrawn this frame from the cached static casters, the others keep their previous contents
+    void CopyStaticCascades()
+    {
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            if (updateMask & (1u << i))
+                glCopyImageSubData(staticShadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+                                   shadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, resolution, resolution, 1);
+        }
+    }
+
+    void SetShadowUniforms(Shader& shader, unsigned int cascadeMask)
+    {
+        shader.bind();
+        shader.setUniformMat4Array("u_lightVP", cascadeCount, lightVP);
+        shader.setUniformInt("u_cascadeMask", (int)cascadeMask);
+        shader.unbind();
+    }
+
+    void SetShadowMapInShader(Shader& shader, int textureUnit)
+    {
+        shader.bind();
+        shader.setUniformMat4Array("u_lightVP", cascadeCount, lightVP);
+        shader.setUniformFloatArray("u_cascadeSplits", cascadeCount, cascadeSplits);
+        shader.setUniformInt("u_cascadeCount", cascadeCount);
+        shader.setUniformInt("u_shadowCascades", textureUnit);
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap);
+        shader.unbind();
+    }
+
+    void bind() { glBindFramebuffer(GL_FRAMEBUFFER, ID); }
+    void bindStatic() { glBindFramebuffer(GL_FRAMEBUFFER, staticID); }
+    void unbind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+    void deleteShadowMap()
+    {
+        glDeleteTextures(1, &shadowMap);
+        glDeleteTextures(1, &staticShadowMap);
+        glDeleteFramebuffers(1, &ID);
+        glDeleteFramebuffers(1, &staticID);
+    }
+
+private:
+    void CreateLayers(unsigned int& framebuffer, unsigned int& texture)
+    {
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, cascadeCount, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+
+        auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
+            LOG_ERROR("ShadowMap", "Cascaded shadow map error: 0x%x", fboStatus);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Returns true if the cascade was refitted, which invalidates its static layer.
+    // The cascade covers a padded sphere and only moves once the slice leaves it, so the cache survives camera motion.
+    bool FitCascade(int cascade, const glm::mat4& view, float fovRadians, float aspect, float sliceNear, float sliceFar)
+    {
+        glm::mat4 inverseSlice = glm::inverse(glm::perspective(fovRadians, aspect, sliceNear, sliceFar) * view);
+        glm::vec3 corners[8];
+        glm::vec3 center = glm::vec3(0.0f);
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec4 corner = inverseSlice * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+            corners[i] = glm::vec3(corner) / corner.w;
+            center += corners[i];
+        }
+        center /= 8.0f;
+
+        // A bounding sphere keeps the projection size constant while the camera rotates
+        float radius = 0.0f;
+        for (auto& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        bool contained = glm::length(center - cachedCenters[cascade]) + radius <= cachedRadii[cascade];
+        if (!forceUpdate && contained && radius * CACHE_PADDING * CACHE_PADDING > cachedRadii[cascade])
+            return false;
+
+        radius = std::ceil(radius * CACHE_PADDING * 16.0f) / 16.0f;
+        cachedCenters[cascade] = center;
+        cachedRadii[cascade] = radius;
+
+        float depth = 2.0f * radius + CASTER_MARGIN;
+        glm::mat4 lightView = glm::lookAt(center - lightDirection * (radius + CASTER_MARGIN), center, lightUp);
+        glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, depth);
+
+        // Snap the projection to whole texels so the shadow edges do not shimmer when the camera moves
+        glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        origin *= (float)resolution / 2.0f;
+        glm::vec2 offset = (glm::vec2(std::round(origin.x), std::round(origin.y)) - glm::vec2(origin.x, origin.y)) * (2.0f / (float)resolution);
+        lightProjection[3][0] += offset.x;
+        lightProjection[3][1] += offset.y;
+
+        lightVP[cascade] = lightProjection * lightView;
+        cascadeDepths[cascade] = depth;
+        casterFrustums[cascade] = Frustum(lightVP[cascade]);
+        casterFrustums[cascade].RemovePlane(Frustum::NEAR_PLANE);
+        return true;
+    }
+
+    // Extra depth behind the light facing side of the cascade sphere for casters outside the view
+    static constexpr float CASTER_MARGIN = 50.0f;
+    // Cascade radius relative to its slice, the room the camera has before the static layer is redrawn
+    static constexpr float CACHE_PADDING = 1.2f;
+
+    int resolution;
+    int cascadeCount;
+    float shadowDistance;
+    float splitLambda;
+    glm::vec3 lightDirection;
+    glm::vec3 lightUp;
+
+    int updateIntervals[MAX_CASCADES];
+    unsigned int updateMask = 0;
+    unsigned int staticUpdateMask = 0;
+    unsigned int staticDirtyMask = 0;
+    unsigned long cachedStaticVersion = 0;
+    unsigned long frameIndex = 0;
+    bool forceUpdate = true;
+
+    float cascadeSplits[MAX_CASCADES] = {};
+    float cascadeDepths[MAX_CASCADES] = {};
+    glm::vec3 cachedCenters[MAX_CASCADES];
+    float cachedRadii[MAX_CASCADES] = {};
+    glm::mat4 lightVP[MAX_CASCADES];
+    Frustum casterFrustums[MAX_CASCADES];
+};
+
+#endif //OPENGL_GAMEENGINE_CASCADEDSHADOWMAP_HPP
@@ -0,0 +1,112 @@
+#ifndef OPENGL_GAMEENGINE_COMMANDLIST_HPP
+#define OPENGL_GAMEENGINE_COMMANDLIST_HPP
+
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Engine/mesh.hpp"
+#include "Engine/shader.hpp"
+
+// A single draw of a mesh, holds no GL state so it can be recorded on any thread
+struct DrawCommand
+{
+    Mesh* mesh;
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+    float depth = 0.0f;     // Squared distance to the view, filled in by Sort
+};
+
+// Draws of one pass. Worker threads record into lists of their own, the merged list is sorted
+// and replayed on the GL thread, which then only sets the per draw uniforms and issues the draw calls.
+class CommandList
+{
+public:
+    void Clear() { commands.clear(); }
+
+    void Add(Mesh* mesh, const glm::mat4& model, const glm::mat3& normalMatrix)
+    {
+        commands.push_back({mesh, model, normalMatrix});
+    }
+
+    void Append(const CommandList& other)
+    {
+        commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+    }
+
+    // Groups the draws by mesh so textures and vertex arrays are bound once per mesh, front to back within a mesh
+    void Sort(const glm::vec3& viewPosition)
+    {
+        for (auto& command : commands)
+        {
+            glm::vec3 offset = glm::vec3(command.model[3]) - viewPosition;
+            command.depth = glm::dot(offset, offset);
+        }
+        std::sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b) {
+            if (a.mesh != b.mesh)
+                return std::less<Mesh*>()(a.mesh, b.mesh);
+            return a.depth < b.depth;
+        });
+    }
+
+    // Groups the draws by mesh only, for passes whose draws have no single view to order them from
+    void SortByMesh()
+    {
+        std::sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b) {
+            return std::less<Mesh*>()(a.mesh, b.mesh);
+        });
+    }
+
+    // Issues the draws with the given shader, has to run on the GL thread
+    void Submit(Shader& shader) const
+    {
+        shader.bind();
+        // Looked up once per list, shaders without normals such as the shadow pass skip the normal matrix
+        GLint modelLocation = glGetUniformLocation(shader.getID(), "u_model");
+        GLint normalMatrixLocation = glGetUniformLocation(shader.getID(), "u_normalMatrix");
+        Mesh* boundMesh = nullptr;
+        for (auto& command : commands)
+        {
+            if (command.mesh != boundMesh)
+            {
+                command.mesh->bind(shader);
+                boundMesh = command.mesh;
+            }
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &command.model[0][0]);
+            if (normalMatrixLocation != -1)
+                glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &command.normalMatrix[0][0]);
+            command.mesh->drawElements();
+        }
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        shader.unbind();
+    }
+
+    // Issues the draws with a shader that only writes depth, binding the vertex arrays but no textures
+    void SubmitDepth(Shader& shader) const
+    {
+        shader.bind();
+        GLint modelLocation = glGetUniformLocation(shader.getID(), "u_model");
+        Mesh* boundMesh = nullptr;
+        for (auto& command : commands)
+        {
+            if (command.mesh != boundMesh)
+            {
+                command.mesh->bindVertices();
+                boundMesh = command.mesh;
+            }
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &command.model[0][0]);
+            command.mesh->drawElements();
+        }
+        glBindVertexArray(0);
+        shader.unbind();
+    }
+
+    int GetSize() const { return (int)commands.size(); }
+    bool IsEmpty() const { return commands.empty(); }
+
+private:
+    std::vector<DrawCommand> commands;
+};
+
+#endif //OPENGL_GAMEENGINE_COMMANDLIST_HPP
@@ -0,0 +1,483 @@
+#ifndef OPENGL_GAMEENGINE_DYNAMICBVH_HPP
+#define OPENGL_GAMEENGINE_DYNAMICBVH_HPP
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Engine/Bounds.hpp"
+
+// Dynamic AABB tree in the style of Box2D's b2DynamicTree.
+// Leaves store "fat" bounds so small movements do not touch the tree, and every
+// insertion walks back to the root applying AVL rotations to keep it shallow.
+template<typename T>
+class DynamicBVH
+{
+public:
+    static constexpr int NullNode = -1;
+
+    explicit DynamicBVH(float margin = 0.1f, float displacementMultiplier = 4.0f)
+        : _margin(margin), _displacementMultiplier(displacementMultiplier) {};
+
+    int CreateProxy(const AABB& bounds, T userData)
+    {
+        int proxyId = AllocateNode();
+        _nodes[proxyId].bounds = bounds.Expanded(_margin);
+        _nodes[proxyId].userData = userData;
+        _nodes[proxyId].height = 0;
+        InsertLeaf(proxyId);
+        _proxyCount++;
+        return proxyId;
+    }
+
+    void DestroyProxy(int proxyId)
+    {
+        assert(_nodes[proxyId].IsLeaf());
+        RemoveLeaf(proxyId);
+        FreeNode(proxyId);
+        _proxyCount--;
+    }
+
+    // Returns true if the proxy bounds changed. Small moves only refit the ancestors,
+    // the leaf is reinserted once it drifts away from where it was inserted.
+    bool MoveProxy(int proxyId, const AABB& bounds, const glm::vec3& displacement = glm::vec3(0.0f))
+    {
+        if (_nodes[proxyId].bounds.Contains(bounds))
+            return false;
+
+        AABB fatBounds = bounds.Expanded(_margin);
+        glm::vec3 prediction = displacement * _displacementMultiplier;
+        fatBounds.min += glm::min(prediction, glm::vec3(0.0f));
+        fatBounds.max += glm::max(prediction, glm::vec3(0.0f));
+
+        if (!_nodes[proxyId].insertBounds.Intersects(fatBounds))
+        {
+            RemoveLeaf(proxyId);
+            _nodes[proxyId].bounds = fatBounds;
+            InsertLeaf(proxyId);
+            return true;
+        }
+
+        // Enlarge the ancestors until one already encloses the new bounds
+        _nodes[proxyId].bounds = fatBounds;
+        int index = _nodes[proxyId].parent;
+        while (index != NullNode && !_nodes[index].bounds.Contains(fatBounds))
+        {
+            _nodes[index].bounds.Extend(fatBounds);
+            index = _nodes[index].parent;
+        }
+        return true;
+    }
+
+    T GetUserData(int proxyId) const { return _nodes[proxyId].userData; }
+    const AABB& GetFatBounds(int proxyId) const { return _nodes[proxyId].bounds; }
+    int GetProxyCount() const { return _proxyCount; }
+    int GetHeight() const { return _root == NullNode ? 0 : _nodes[_root].height; }
+
+    // Reinserts a few leaves per call, shrinking the ancestors enlarged by incremental refits
+    void Rebalance(int iterations)
+    {
+        if (_root == NullNode || _nodes.empty())
+            return;
+
+        int nodeCount = (int)_nodes.size();
+        for (int i = 0; i < iterations; i++)
+        {
+            int visited = 0;
+            while (_nodes[_rebalanceCursor].height != 0 && visited < nodeCount)
+            {
+                _rebalanceCursor = (_rebalanceCursor + 1) % nodeCount;
+                visited++;
+            }
+            if (visited >= nodeCount)
+                return;
+
+            int leaf = _rebalanceCursor;
+            _rebalanceCursor = (_rebalanceCursor + 1) % nodeCount;
+            RemoveLeaf(leaf);
+            InsertLeaf(leaf);
+        }
+    }
+
+    // Callback: bool(T userData), return false to stop the query
+    template<typename Callback>
+    void Query(const AABB& bounds, Callback&& callback) const
+    {
+        Traverse([&bounds](const AABB& nodeBounds) { return nodeBounds.Intersects(bounds); }, callback);
+    }
+
+    template<typename Callback>
+    void Query(const Sphere& sphere, Callback&& callback) const
+    {
+        Traverse([&sphere](const AABB& nodeBounds) { return sphere.Intersects(nodeBounds); }, callback);
+    }
+
+    // Subtrees fully inside the frustum are reported without testing their children again
+    template<typename Callback>
+    void Query(const Frustum& frustum, Callback&& callback) const
+    {
+        if (_root == NullNode)
+            return;
+
+        StackEntry stack[StackSize];
+        int stackCount = 0;
+        stack[stackCount++] = {_root, frustum.activePlanes};
+        while (stackCount > 0)
+        {
+            StackEntry entry = stack[--stackCount];
+            const Node& node = _nodes[entry.node];
+            unsigned int planeMask = entry.planeMask;
+            if (planeMask != 0 && frustum.Test(node.bounds, planeMask) == FrustumTest::OUTSIDE)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                if (!callback(node.userData))
+                    return;
+            }
+            else
+            {
+                assert(stackCount + 2 <= StackSize);
+                stack[stackCount++] = {node.child1, planeMask};
+                stack[stackCount++] = {node.child2, planeMask};
+            }
+        }
+    }
+
+    // Callback: float(T userData, float distance), returns the new maximum ray distance
+    // (the hit distance to clip the ray, maxDistance to continue, 0 to stop)
+    template<typename Callback>
+    void RayCast(const Ray& ray, float maxDistance, Callback&& callback) const
+    {
+        if (_root == NullNode)
+            return;
+
+        int stack[StackSize];
+        int stackCount = 0;
+        stack[stackCount++] = _root;
+        while (stackCount > 0)
+        {
+            const Node& node = _nodes[stack[--stackCount]];
+            float distance = ray.Intersect(node.bounds, maxDistance);
+            if (distance < 0.0f)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                float newMaxDistance = callback(node.userData, distance);
+                if (newMaxDistance <= 0.0f)
+                    return;
+                maxDistance = std::min(maxDistance, newMaxDistance);
+            }
+            else
+            {
+                assert(stackCount + 2 <= StackSize);
+                stack[stackCount++] = node.child1;
+                stack[stackCount++] = node.child2;
+            }
+        }
+    }
+
+private:
+    static constexpr int StackSize = 256;
+
+    struct Node
+    {
+        AABB bounds;
+        // Leaf bounds at the time of the last insertion
+        AABB insertBounds;
+        T userData = T();
+        int parent = NullNode;
+        int child1 = NullNode;
+        int child2 = NullNode;
+        int next = NullNode;
+        // Leaf = 0, free node = -1
+        int height = -1;
+
+        bool IsLeaf() const { return child1 == NullNode; }
+    };
+
+    struct StackEntry
+    {
+        int node;
+        unsigned int planeMask;
+    };
+
+    template<typename Overlap, typename Callback>
+    void Traverse(Overlap&& overlap, Callback& callback) const
+    {
+        if (_root == NullNode)
+            return;
+
+        int stack[StackSize];
+        int stackCount = 0;
+        stack[stackCount++] = _root;
+        while (stackCount > 0)
+        {
+            const Node& node = _nodes[stack[--stackCount]];
+            if (!overlap(node.bounds))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                if (!callback(node.userData))
+                    return;
+            }
+            else
+            {
+                assert(stackCount + 2 <= StackSize);
+                stack[stackCount++] = node.child1;
+                stack[stackCount++] = node.child2;
+            }
+        }
+    }
+
+    int AllocateNode()
+    {
+        if (_freeList == NullNode)
+        {
+            _nodes.emplace_back();
+            return (int)_nodes.size() - 1;
+        }
+
+        int nodeId = _freeList;
+        _freeList = _nodes[nodeId].next;
+        _nodes[nodeId] = Node();
+        return nodeId;
+    }
+
+    void FreeNode(int nodeId)
+    {
+        _nodes[nodeId].next = _freeList;
+        _nodes[nodeId].height = -1;
+        _nodes[nodeId].userData = T();
+        _freeList = nodeId;
+    }
+
+    float InsertionCost(int nodeId, const AABB& leafBounds) const
+    {
+        const Node& node = _nodes[nodeId];
+        float mergedArea = AABB::Merge(leafBounds, node.bounds).GetSurfaceArea();
+        return node.IsLeaf() ? mergedArea : mergedArea - node.bounds.GetSurfaceArea();
+    }
+
+    void InsertLeaf(int leaf)
+    {
+        _nodes[leaf].insertBounds = _nodes[leaf].bounds;
+        if (_root == NullNode)
+        {
+            _root = leaf;
+            _nodes[_root].parent = NullNode;
+            return;
+        }
+
+        // Find the best sibling using the surface area heuristic
+        AABB leafBounds = _nodes[leaf].bounds;
+        int index = _root;
+        while (!_nodes[index].IsLeaf())
+        {
+            const Node& node = _nodes[index];
+            float area = node.bounds.GetSurfaceArea();
+            float combinedArea = AABB::Merge(node.bounds, leafBounds).GetSurfaceArea();
+
+            // Cost of creating a new parent for this node and the new leaf
+            float cost = 2.0f * combinedArea;
+            // Minimum cost of pushing the leaf further down the tree
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float cost1 = InsertionCost(node.child1, leafBounds) + inheritanceCost;
+            float cost2 = InsertionCost(node.child2, leafBounds) + inheritanceCost;
+
+            if (cost < cost1 && cost < cost2)
+                break;
+
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int sibling = index;
+        int oldParent = _nodes[sibling].parent;
+        int newParent = AllocateNode();
+        _nodes[newParent].parent = oldParent;
+        _nodes[newParent].bounds = AABB::Merge(leafBounds, _nodes[sibling].bounds);
+        _nodes[newParent].height = _nodes[sibling].height + 1;
+        _nodes[newParent].child1 = sibling;
+        _nodes[newParent].child2 = leaf;
+        _nodes[sibling].parent = newParent;
+        _nodes[leaf].parent = newParent;
+
+        if (oldParent != NullNode)
+        {
+            if (_nodes[oldParent].child1 == sibling)
+                _nodes[oldParent].child1 = newParent;
+            else
+                _nodes[oldParent].child2 = newParent;
+        }
+        else
+        {
+            _root = newParent;
+        }
+
+        RefitAncestors(_nodes[leaf].parent);
+    }
+
+    void RemoveLeaf(int leaf)
+    {
+        if (leaf == _root)
+        {
+            _root = NullNode;
+            return;
+        }
+
+        int parent = _nodes[leaf].parent;
+        int grandParent = _nodes[parent].parent;
+        int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+        if (grandParent != NullNode)
+        {
+            if (_nodes[grandParent].child1 == parent)
+                _nodes[grandParent].child1 = sibling;
+            else
+                _nodes[grandParent].child2 = sibling;
+            _nodes[sibling].parent = grandParent;
+            FreeNode(parent);
+
+            RefitAncestors(grandParent);
+        }
+        else
+        {
+            _root = sibling;
+            _nodes[sibling].parent = NullNode;
+            FreeNode(parent);
+        }
+    }
+
+    void RefitAncestors(int index)
+    {
+        while (index != NullNode)
+        {
+            index = Balance(index);
+
+            Node& node = _nodes[index];
+            const Node& child1 = _nodes[node.child1];
+            const Node& child2 = _nodes[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.bounds = AABB::Merge(child1.bounds, child2.bounds);
+
+            index = node.parent;
+        }
+    }
+
+    // Performs a left or right rotation if node A is imbalanced, returns the new subtree root
+    int Balance(int iA)
+    {
+        Node* A = &_nodes[iA];
+        if (A->IsLeaf() || A->height < 2)
+            return iA;
+
+        int iB = A->child1;
+        int iC = A->child2;
+        Node* B = &_nodes[iB];
+        Node* C = &_nodes[iC];
+
+        int balance = C->height - B->height;
+
+        // Rotate C up
+        if (balance > 1)
+        {
+            int iF = C->child1;
+            int iG = C->child2;
+            Node* F = &_nodes[iF];
+            Node* G = &_nodes[iG];
+
+            C->child1 = iA;
+            C->parent = A->parent;
+            A->parent = iC;
+            ReplaceChild(C->parent, iA, iC);
+
+            if (F->height > G->height)
+            {
+                C->child2 = iF;
+                A->child2 = iG;
+                G->parent = iA;
+                A->bounds = AABB::Merge(B->bounds, G->bounds);
+                C->bounds = AABB::Merge(A->bounds, F->bounds);
+                A->height = 1 + std::max(B->height, G->height);
+                C->height = 1 + std::max(A->height, F->height);
+            }
+            else
+            {
+                C->child2 = iG;
+                A->child2 = iF;
+                F->parent = iA;
+                A->bounds = AABB::Merge(B->bounds, F->bounds);
+                C->bounds = AABB::Merge(A->bounds, G->bounds);
+                A->height = 1 + std::max(B->height, F->height);
+                C->height = 1 + std::max(A->height, G->height);
+            }
+            return iC;
+        }
+
+        // Rotate B up
+        if (balance < -1)
+        {
+            int iD = B->child1;
+            int iE = B->child2;
+            Node* D = &_nodes[iD];
+            Node* E = &_nodes[iE];
+
+            B->child1 = iA;
+            B->parent = A->parent;
+            A->parent = iB;
+            ReplaceChild(B->parent, iA, iB);
+
+            if (D->height > E->height)
+            {
+                B->child2 = iD;
+                A->child1 = iE;
+                E->parent = iA;
+                A->bounds = AABB::Merge(C->bounds, E->bounds);
+                B->bounds = AABB::Merge(A->bounds, D->bounds);
+                A->height = 1 + std::max(C->height, E->height);
+                B->height = 1 + std::max(A->height, D->height);
+            }
+            else
+            {
+                B->child2 = iE;
+                A->child1 = iD;
+                D->parent = iA;
+                A->bounds = AABB::Merge(C->bounds, D->bounds);
+                B->bounds = AABB::Merge(A->bounds, E->bounds);
+                A->height = 1 + std::max(C->height, D->height);
+                B->height = 1 + std::max(A->height, E->height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+
+    void ReplaceChild(int parent, int oldChild, int newChild)
+    {
+        if (parent == NullNode)
+        {
+            _root = newChild;
+            return;
+        }
+
+        if (_nodes[parent].child1 == oldChild)
+            _nodes[parent].child1 = newChild;
+        else
+            _nodes[parent].child2 = newChild;
+    }
+
+    std::vector<Node> _nodes;
+    int _root = NullNode;
+    int _freeList = NullNode;
+    int _proxyCount = 0;
+    int _rebalanceCursor = 0;
+
+    float _margin;
+    float _displacementMultiplier;
+};
+
+#endif //OPENGL_GAMEENGINE_DYNAMICBVH_HPP
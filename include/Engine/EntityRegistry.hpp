@@ -0,0 +1,439 @@
+#ifndef OPENGL_GAMEENGINE_ENTITYREGISTRY_HPP
+#define OPENGL_GAMEENGINE_ENTITYREGISTRY_HPP
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+
+// Handle of an entity, the generation tells a reused index apart from the entity destroyed before
+struct Entity
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t index = NONE;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Type erased operations of every component type, ids are handed out on first use
+class ComponentTypes
+{
+public:
+    static constexpr int MAX_TYPES = 64;
+
+    struct Info
+    {
+        size_t size;
+        size_t alignment;
+        void (*moveConstruct)(void* destination, void* source);
+        void (*destroy)(void* component);
+    };
+
+    template<typename T>
+    static int GetId()
+    {
+        static const int id = Register({sizeof(T), alignof(T),
+                [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+                [](void* component) { static_cast<T*>(component)->~T(); }});
+        return id;
+    }
+
+    template<typename... Ts>
+    static uint64_t GetMask()
+    {
+        return (0ull | ... | (1ull << GetId<Ts>()));
+    }
+
+    static const Info& Get(int id) { return _infos[id]; }
+
+private:
+    static int Register(const Info& info)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count >= MAX_TYPES)
+        {
+            LOG_ERROR("ECS", "More than %d component types", MAX_TYPES);
+            Log::Flush();
+            std::abort();
+        }
+        _infos[_count] = info;
+        return _count++;
+    }
+
+    inline static std::array<Info, MAX_TYPES> _infos{};
+    inline static int _count = 0;
+    inline static std::mutex _mutex;
+};
+
+// Entities sharing the same set of component types. Rows are packed into fixed size chunks, every chunk holds the
+// entity handles followed by one array per component type, so a system walks contiguous memory per component.
+class Archetype
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    explicit Archetype(uint64_t mask) : _mask(mask)
+    {
+        _columnOfType.fill(-1);
+        size_t rowSize = sizeof(Entity);
+        for (int id = 0; id < ComponentTypes::MAX_TYPES; id++)
+        {
+            if ((mask >> id) & 1)
+            {
+                _columnOfType[id] = (int)_types.size();
+                _types.push_back(id);
+                rowSize += ComponentTypes::Get(id).size;
+            }
+        }
+        _offsets.resize(_types.size());
+
+        // Alignment padding may push the estimate over the chunk size
+        _capacity = (int)(CHUNK_SIZE / rowSize);
+        while (_capacity > 0 && !Layout())
+            _capacity--;
+        if (_capacity == 0)
+        {
+            LOG_ERROR("ECS", "Components of %zu bytes do not fit a chunk", rowSize);
+            Log::Flush();
+            std::abort();
+        }
+    }
+
+    ~Archetype()
+    {
+        for (int row = 0; row < _count; row++)
+            DestroyRow(row);
+    }
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    uint64_t GetMask() const { return _mask; }
+    const std::vector<int>& GetTypes() const { return _types; }
+    bool HasType(int id) const { return (_mask >> id) & 1; }
+    int GetCount() const { return _count; }
+
+    int GetChunkCount() const { return (_count + _capacity - 1) / _capacity; }
+    int GetChunkSize(int chunk) const { return std::min(_capacity, _count - chunk * _capacity); }
+
+    Entity* GetEntities(int chunk) { return reinterpret_cast<Entity*>(_chunks[chunk]->data); }
+
+    template<typename T>
+    T* GetArray(int chunk)
+    {
+        return reinterpret_cast<T*>(_chunks[chunk]->data + _offsets[_columnOfType[ComponentTypes::GetId<T>()]]);
+    }
+
+    void* GetComponent(int id, int row)
+    {
+        int column = _columnOfType[id];
+        Chunk& chunk = *_chunks[row / _capacity];
+        return chunk.data + _offsets[column] + (row % _capacity) * ComponentTypes::Get(id).size;
+    }
+
+    // Appends a row, its components are left unconstructed for the caller
+    int PushRow(Entity entity)
+    {
+        if (_count == (int)_chunks.size() * _capacity)
+            _chunks.emplace_back(new Chunk);
+        GetEntities(_count / _capacity)[_count % _capacity] = entity;
+        return _count++;
+    }
+
+    // Destroys the components of the row and moves the last row into the hole. Returns the moved entity, or an
+    // entity with index NONE if the removed row was the last one.
+    Entity RemoveRow(int row)
+    {
+        DestroyRow(row);
+        int last = _count - 1;
+        Entity moved;
+        if (row != last)
+        {
+            for (int id : _types)
+                MoveComponent(id, row, last);
+            moved = GetEntities(last / _capacity)[last % _capacity];
+            GetEntities(row / _capacity)[row % _capacity] = moved;
+        }
+        // Chunks are kept once allocated, entities coming and going do not allocate
+        _count--;
+        return moved;
+    }
+
+private:
+    struct Chunk
+    {
+        alignas(64) unsigned char data[CHUNK_SIZE];
+    };
+
+    bool Layout()
+    {
+        size_t offset = _capacity * sizeof(Entity);
+        for (size_t column = 0; column < _types.size(); column++)
+        {
+            const ComponentTypes::Info& info = ComponentTypes::Get(_types[column]);
+            offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+            _offsets[column] = offset;
+            offset += _capacity * info.size;
+        }
+        return offset <= CHUNK_SIZE;
+    }
+
+    void DestroyRow(int row)
+    {
+        for (int id : _types)
+            ComponentTypes::Get(id).destroy(GetComponent(id, row));
+    }
+
+    void MoveComponent(int id, int destination, int source)
+    {
+        const ComponentTypes::Info& info = ComponentTypes::Get(id);
+        void* sourceComponent = GetComponent(id, source);
+        info.moveConstruct(GetComponent(id, destination), sourceComponent);
+        info.destroy(sourceComponent);
+    }
+
+    uint64_t _mask;
+    std::vector<int> _types;
+    std::array<int, ComponentTypes::MAX_TYPES> _columnOfType;
+    std::vector<size_t> _offsets;
+    int _capacity = 0;
+    int _count = 0;
+    std::vector<std::unique_ptr<Chunk>> _chunks;
+};
+
+// Entities and their components, grouped into archetypes by their component types. Adding or removing a component
+// moves the entity to another archetype, so those are the expensive operations; iterating is a walk over chunks.
+// Components may be any movable type. Pointers to components are invalidated by adding or removing components or
+// entities, systems must not do either while iterating.
+class EntityRegistry
+{
+public:
+    using System = void (*)(EntityRegistry& entities);
+
+    EntityRegistry()
+    {
+        _archetypes.push_back(std::make_unique<Archetype>(0));
+        _archetypeOfMask[0] = 0;
+    }
+
+    EntityRegistry(const EntityRegistry&) = delete;
+    EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+    Entity Create()
+    {
+        uint32_t index;
+        if (!_freeIndices.empty())
+        {
+            index = _freeIndices.back();
+            _freeIndices.pop_back();
+        }
+        else
+        {
+            index = (uint32_t)_records.size();
+            _records.emplace_back();
+        }
+
+        Record& record = _records[index];
+        Entity entity{index, record.generation};
+        record.archetype = 0;
+        record.row = _archetypes[0]->PushRow(entity);
+        return entity;
+    }
+
+    void Destroy(Entity entity)
+    {
+        if (!IsAlive(entity))
+            return;
+
+        Record& record = _records[entity.index];
+        RemoveRow(record.archetype, record.row);
+        record.generation++;
+        record.archetype = -1;
+        _freeIndices.push_back(entity.index);
+    }
+
+    bool IsAlive(Entity entity) const
+    {
+        return entity.index < _records.size() && _records[entity.index].generation == entity.generation;
+    }
+
+    int GetEntityCount() const { return (int)(_records.size() - _freeIndices.size()); }
+
+    // Constructs the component from the arguments, replacing the entity's component of the same type if it has one
+    template<typename T, typename... Args>
+    T& Add(Entity entity, Args&&... args)
+    {
+        int id = ComponentTypes::GetId<T>();
+        Record& record = _records[entity.index];
+        Archetype* archetype = _archetypes[record.archetype].get();
+        if (archetype->HasType(id))
+        {
+            T& component = *static_cast<T*>(archetype->GetComponent(id, record.row));
+            component = T{std::forward<Args>(args)...};
+            return component;
+        }
+
+        MoveEntity(entity, GetArchetype(archetype->GetMask() | (1ull << id)));
+        archetype = _archetypes[record.archetype].get();
+        return *new (archetype->GetComponent(id, record.row)) T{std::forward<Args>(args)...};
+    }
+
+    template<typename T>
+    void Remove(Entity entity)
+    {
+        if (!Has<T>(entity))
+            return;
+        uint64_t mask = _archetypes[_records[entity.index].archetype]->GetMask();
+        MoveEntity(entity, GetArchetype(mask & ~(1ull << ComponentTypes::GetId<T>())));
+    }
+
+    template<typename T>
+    bool Has(Entity entity) const
+    {
+        return IsAlive(entity) && _archetypes[_records[entity.index].archetype]->HasType(ComponentTypes::GetId<T>());
+    }
+
+    // The entity has to have the component
+    template<typename T>
+    T& Get(Entity entity)
+    {
+        const Record& record = _records[entity.index];
+        return *static_cast<T*>(_archetypes[record.archetype]->GetComponent(ComponentTypes::GetId<T>(), record.row));
+    }
+
+    // nullptr if the entity is destroyed or does not have the component
+    template<typename T>
+    T* TryGet(Entity entity)
+    {
+        return Has<T>(entity) ? &Get<T>(entity) : nullptr;
+    }
+
+    // Calls function(count, entities, components...) with the arrays of every chunk whose entities have all of the types
+    template<typename... Ts, typename Function>
+    void EachChunk(Function&& function)
+    {
+        uint64_t mask = ComponentTypes::GetMask<Ts...>();
+        for (auto& archetype : _archetypes)
+        {
+            if ((archetype->GetMask() & mask) != mask)
+                continue;
+            for (int chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+                function(archetype->GetChunkSize(chunk), archetype->GetEntities(chunk), archetype->template GetArray<Ts>(chunk)...);
+        }
+    }
+
+    // Calls function(entity, components...) for every entity having all of the types
+    template<typename... Ts, typename Function>
+    void Each(Function&& function)
+    {
+        EachChunk<Ts...>([&function](int count, Entity* entities, Ts*... components) {
+            for (int i = 0; i < count; i++)
+                function(entities[i], components[i]...);
+        });
+    }
+
+    // Each spread over the job system's threads chunk by chunk, the function is called concurrently
+    template<typename... Ts, typename Function>
+    void ParallelEach(JobSystem& jobSystem, Function&& function)
+    {
+        _chunkList.clear();
+        uint64_t mask = ComponentTypes::GetMask<Ts...>();
+        for (auto& archetype : _archetypes)
+        {
+            if ((archetype->GetMask() & mask) != mask)
+                continue;
+            for (int chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+                _chunkList.push_back({archetype.get(), chunk});
+        }
+
+        jobSystem.ParallelFor((int)_chunkList.size(), 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                Archetype* archetype = _chunkList[i].first;
+                int chunk = _chunkList[i].second;
+                Entity* entities = archetype->GetEntities(chunk);
+                int count = archetype->GetChunkSize(chunk);
+                for (int row = 0; row < count; row++)
+                    function(entities[row], archetype->template GetArray<Ts>(chunk)[row]...);
+            }
+        });
+    }
+
+    // Systems run in the order they were added, adding one twice has no effect
+    void AddSystem(System system)
+    {
+        if (std::find(_systems.begin(), _systems.end(), system) == _systems.end())
+            _systems.push_back(system);
+    }
+
+    void RunSystems()
+    {
+        for (System system : _systems)
+            system(*this);
+    }
+
+private:
+    struct Record
+    {
+        uint32_t generation = 0;
+        int archetype = -1;
+        int row = 0;
+    };
+
+    int GetArchetype(uint64_t mask)
+    {
+        auto it = _archetypeOfMask.find(mask);
+        if (it != _archetypeOfMask.end())
+            return it->second;
+
+        _archetypes.push_back(std::make_unique<Archetype>(mask));
+        int index = (int)_archetypes.size() - 1;
+        _archetypeOfMask[mask] = index;
+        return index;
+    }
+
+    // Moves the components both archetypes have, the ones the target lacks are destroyed
+    void MoveEntity(Entity entity, int targetIndex)
+    {
+        Record& record = _records[entity.index];
+        Archetype& source = *_archetypes[record.archetype];
+        Archetype& target = *_archetypes[targetIndex];
+
+        int row = target.PushRow(entity);
+        for (int id : target.GetTypes())
+        {
+            if (source.HasType(id))
+                ComponentTypes::Get(id).moveConstruct(target.GetComponent(id, row), source.GetComponent(id, record.row));
+        }
+        RemoveRow(record.archetype, record.row);
+        record.archetype = targetIndex;
+        record.row = row;
+    }
+
+    void RemoveRow(int archetype, int row)
+    {
+        Entity moved = _archetypes[archetype]->RemoveRow(row);
+        if (moved.index != Entity::NONE)
+            _records[moved.index].row = row;
+    }
+
+    std::vector<std::unique_ptr<Archetype>> _archetypes;
+    std::unordered_map<uint64_t, int> _archetypeOfMask;
+    std::vector<Record> _records;
+    std::vector<uint32_t> _freeIndices;
+    std::vector<System> _systems;
+    std::vector<std::pair<Archetype*, int>> _chunkList;
+};
+
+#endif //OPENGL_GAMEENGINE_ENTITYREGISTRY_HPP
@@ -3,7 +3,7 @@
 
 #include <glad/glad.h>
 #include <vector>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <glm/glm.hpp>
 
 class FBO
@@ -30,12 +30,12 @@ public:
 
         glGenRenderbuffers(1, &depthRenderBuffer);
         glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer);
 
         auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
         if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
-            std::cout<< "Framebuffer error:" << fboStatus << std::endl;
+            LOG_ERROR("FBO", "Framebuffer error: 0x%x", fboStatus);
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -52,7 +52,7 @@ public:
 
         glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0); 
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
 
         glBindFramebuffer(GL_FRAMEBUFFER,0);
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -0,0 +1,181 @@
+#ifndef OPENGL_GAMEENGINE_FRAMEALLOCATOR_HPP
+#define OPENGL_GAMEENGINE_FRAMEALLOCATOR_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// Bump allocator for memory that is only used until the end of the frame. Every thread allocates from its own arena,
+// so allocating takes no lock, and Reset frees the whole frame at once. Arenas keep the blocks they grew to, once they
+// reached the size a frame needs, allocating does not touch the heap anymore.
+//
+// Memory handed to another loop, such as the snapshot the render thread submits, must not come from the allocator of
+// the loop that prepared it, that one is reset before the other loop is done with it.
+class FrameAllocator
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    // Allocator of the main loop, reset at the end of every Application::Run iteration
+    static FrameAllocator& GetInstance()
+    {
+        static FrameAllocator instance;
+        return instance;
+    }
+
+    // Allocator of the calling thread's loop, the main loop's one unless the thread made another one current
+    static FrameAllocator& GetCurrent()
+    {
+        return _current != nullptr ? *_current : GetInstance();
+    }
+
+    FrameAllocator() = default;
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // Makes this the allocator GetCurrent returns on the calling thread
+    void MakeCurrent() { _current = this; }
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        Arena& arena = GetArena();
+        // Arenas start over lazily, so only the owning thread ever touches one
+        unsigned int frame = _frame.load(std::memory_order_acquire);
+        if (arena.frame != frame)
+        {
+            arena.frame = frame;
+            arena.block = 0;
+            arena.offset = 0;
+        }
+
+        while (true)
+        {
+            if (arena.block < arena.blocks.size())
+            {
+                Block& block = arena.blocks[arena.block];
+                uintptr_t start = (uintptr_t)block.memory.get();
+                size_t offset = ((start + arena.offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - start;
+                if (offset + size <= block.size)
+                {
+                    arena.offset = offset + size;
+                    return block.memory.get() + offset;
+                }
+                arena.block++;
+                arena.offset = 0;
+                continue;
+            }
+
+            // Larger requests get a block of their own, it is kept and reused like the others
+            size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+            arena.blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+            _reservedBytes.fetch_add(blockSize, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename T>
+    T* Allocate(size_t count)
+    {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Frees everything allocated with this allocator, on every thread
+    void Reset()
+    {
+        _frame.fetch_add(1, std::memory_order_release);
+    }
+
+    // Bytes of all blocks of all arenas, stops growing once the frames reached their size
+    size_t GetReservedBytes() const { return _reservedBytes.load(std::memory_order_relaxed); }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    struct Arena
+    {
+        std::thread::id thread;
+        std::vector<Block> blocks;
+        size_t block = 0;
+        size_t offset = 0;
+        unsigned int frame = 0;
+    };
+
+    Arena& GetArena()
+    {
+        // Threads mostly allocate from a single allocator, the last arena used is cached
+        if (_cachedAllocator == _id)
+            return *_cachedArena;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::thread::id thread = std::this_thread::get_id();
+        auto found = std::find_if(_arenas.begin(), _arenas.end(), [thread](const std::unique_ptr<Arena>& arena) {
+            return arena->thread == thread;
+        });
+        if (found == _arenas.end())
+        {
+            _arenas.push_back(std::make_unique<Arena>());
+            _arenas.back()->thread = thread;
+            _arenas.back()->frame = _frame.load(std::memory_order_acquire);
+            found = _arenas.end() - 1;
+        }
+        _cachedAllocator = _id;
+        _cachedArena = found->get();
+        return *_cachedArena;
+    }
+
+    // Ids instead of addresses, a new allocator may take the place of a destroyed one
+    inline static std::atomic<unsigned int> _allocatorCount{0};
+    const unsigned int _id = ++_allocatorCount;
+
+    std::atomic<unsigned int> _frame{0};
+    std::atomic<size_t> _reservedBytes{0};
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<Arena>> _arenas;
+
+    inline static thread_local FrameAllocator* _current = nullptr;
+    inline static thread_local unsigned int _cachedAllocator = 0;
+    inline static thread_local Arena* _cachedArena = nullptr;
+};
+
+// Standard library allocator on top of the FrameAllocator, deallocating does nothing since Reset frees the frame.
+// Containers using it are only valid until the end of the frame and should be reserved up front, a grown container
+// leaves its old storage behind until then.
+template<typename T>
+class FrameStdAllocator
+{
+public:
+    using value_type = T;
+
+    FrameStdAllocator() : _allocator(&FrameAllocator::GetCurrent()) {}
+    explicit FrameStdAllocator(FrameAllocator& allocator) : _allocator(&allocator) {}
+    template<typename U>
+    FrameStdAllocator(const FrameStdAllocator<U>& other) : _allocator(other.GetAllocator()) {}
+
+    T* allocate(size_t count) { return _allocator->Allocate<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    FrameAllocator* GetAllocator() const { return _allocator; }
+
+    template<typename U>
+    bool operator==(const FrameStdAllocator<U>& other) const { return _allocator == other.GetAllocator(); }
+    template<typename U>
+    bool operator!=(const FrameStdAllocator<U>& other) const { return _allocator != other.GetAllocator(); }
+
+private:
+    FrameAllocator* _allocator;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameStdAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameStdAllocator<char>>;
+
+#endif //OPENGL_GAMEENGINE_FRAMEALLOCATOR_HPP
@@ -1,123 +0,0 @@
-#ifndef OPENGL_GAMEENGINE_GBUFFER_HPP
-#define OPENGL_GAMEENGINE_GBUFFER_HPP
-
-#include <glad/glad.h>
-#include <vector>
-#include <glm/glm.hpp>
-#include <iostream>
-
-class GBuffer
-{
-public:
-    unsigned int ID;
-    unsigned int gPosition;
-    unsigned int gNormal;
-    unsigned int gAlbedoSpec;
-    unsigned int depthRenderBuffer;
-
-    GBuffer() : GBuffer(1280, 720) {};
-
-    GBuffer(int width, int height)
-    {
-        size = glm::vec2(width, height);
-        glGenFramebuffers(1, &ID);
-        glBindFramebuffer(GL_FRAMEBUFFER, ID);
-
-        // Position
-        glGenTextures(1, &gPosition);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-
-        // Normal
-        glGenTextures(1, &gNormal);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-
-        // Albedo + Specular
-        glGenTextures(1, &gAlbedoSpec);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
-
-        // Attachments
-        glDrawBuffers(3, attachments);
-
-        // Depth
-        glGenRenderbuffers(1, &depthRenderBuffer);
-        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer);
-
-        auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-        if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
-            std::cout<< "GBuffer error:" << fboStatus << std::endl;
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    }
-
-    void resize(int width, int height)
-    {
-        size = glm::vec2(width, height);
-        glBindFramebuffer(GL_FRAMEBUFFER, ID);
-
-        // Position
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA16F, GL_FLOAT, NULL);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-
-        // Normal
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA16F, GL_FLOAT, NULL);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-
-        // Albedo + Specular
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA16F, GL_FLOAT, NULL);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
-
-        glDrawBuffers(3, attachments);
-
-        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-
-        glBindFramebuffer(GL_FRAMEBUFFER,0);
-    }
-
-    glm::vec2 GetSize()
-    {
-        return size;
-    }
-
-    void BindTextures(Shader& shader)
-    {
-        shader.bind();
-        shader.setUniformInt("gPosition", 0);
-        shader.setUniformInt("gNormal", 1);
-        shader.setUniformInt("gAlbedoSpec", 2);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE0 + 1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glActiveTexture(GL_TEXTURE0 + 2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        shader.unbind();
-    }
-
-    void bind() { glBindFramebuffer(GL_FRAMEBUFFER, ID);}
-    void unbind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
-    void deleteGBuffer() { glDeleteFramebuffers(1, &ID); }
-
-private:
-    glm::vec2 size;
-    unsigned int attachments[3] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
-};
-
-#endif //OPENGL_GAMEENGINE_GBUFFER_HPP
@@ -0,0 +1,195 @@
+#ifndef OPENGL_GAMEENGINE_GPUPROFILER_HPP
+#define OPENGL_GAMEENGINE_GPUPROFILER_HPP
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "Engine/Log.hpp"
+#include <algorithm>
+
+// GPU time of named render passes measured with GL_TIMESTAMP queries.
+// Every frame writes into its own query set and the results are read FRAME_LATENCY frames later,
+// by then the GPU has finished them so the read back never stalls.
+// Each timed scope is also a KHR_debug group, so the passes show up by name in frame debuggers.
+class GpuProfiler
+{
+public:
+    static constexpr int FRAME_LATENCY = 3;
+    static constexpr int HISTORY_SIZE = 240;
+
+    // Times the GL commands issued during its lifetime, scopes may nest
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler& profiler, int pass) : profiler(profiler), pass(pass) { profiler.BeginPass(pass); }
+        ~Scope() { profiler.EndPass(pass); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuProfiler& profiler;
+        int pass;
+    };
+
+    // Id of the pass with this name, registers it on first use
+    int GetPassId(const std::string& name)
+    {
+        for (int i = 0; i < (int)passes.size(); i++)
+        {
+            if (passes[i].name == name)
+                return i;
+        }
+
+        Pass pass;
+        pass.name = name;
+        pass.history.resize(HISTORY_SIZE, 0.0f);
+        passes.push_back(pass);
+        for (auto& frame : frames)
+        {
+            frame.queries.resize(passes.size() * 2, 0);
+            frame.issued.resize(passes.size(), false);
+            frame.depth.resize(passes.size(), 0);
+            glGenQueries(2, &frame.queries[(passes.size() - 1) * 2]);
+        }
+        return (int)passes.size() - 1;
+    }
+
+    // Reads back the results of the query set this frame is about to reuse
+    void BeginFrame()
+    {
+        frameIndex = (frameIndex + 1) % FRAME_LATENCY;
+        Frame& frame = frames[frameIndex];
+
+        // Queries complete in order, once the frame's last timestamp is available all of them are
+        GLint available = 0;
+        if (frame.lastTimestamp != 0)
+            glGetQueryObjectiv(frame.lastTimestamp, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available)
+        {
+            historyIndex = (historyIndex + 1) % HISTORY_SIZE;
+            frameTime = 0.0f;
+            for (int pass = 0; pass < (int)passes.size(); pass++)
+            {
+                float time = 0.0f;
+                if (frame.issued[pass])
+                {
+                    GLuint64 begin = 0, end = 0;
+                    glGetQueryObjectui64v(frame.queries[pass * 2], GL_QUERY_RESULT, &begin);
+                    glGetQueryObjectui64v(frame.queries[pass * 2 + 1], GL_QUERY_RESULT, &end);
+                    time = (float)(end - begin) / 1000000.0f;
+                    // Nested passes are already part of their parent
+                    if (frame.depth[pass] == 0)
+                        frameTime += time;
+                }
+                passes[pass].time = time;
+                passes[pass].history[historyIndex] = time;
+            }
+            resultFrames++;
+        }
+
+        std::fill(frame.issued.begin(), frame.issued.end(), false);
+        frame.lastTimestamp = 0;
+        depth = 0;
+    }
+
+    void BeginPass(int pass)
+    {
+        Frame& frame = frames[frameIndex];
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, pass, -1, passes[pass].name.c_str());
+        glQueryCounter(frame.queries[pass * 2], GL_TIMESTAMP);
+        frame.depth[pass] = depth++;
+    }
+
+    void EndPass(int pass)
+    {
+        Frame& frame = frames[frameIndex];
+        glQueryCounter(frame.queries[pass * 2 + 1], GL_TIMESTAMP);
+        glPopDebugGroup();
+        frame.issued[pass] = true;
+        frame.lastTimestamp = frame.queries[pass * 2 + 1];
+        depth--;
+    }
+
+    // Milliseconds of the pass in the latest frame with results, 0 if the pass did not run
+    float GetPassTime(int pass) const { return passes[pass].time; }
+    // Milliseconds of the pass framesAgo result frames before the latest one
+    float GetPassHistory(int pass, int framesAgo) const
+    {
+        return passes[pass].history[(historyIndex - framesAgo % HISTORY_SIZE + HISTORY_SIZE) % HISTORY_SIZE];
+    }
+    float GetPassAverage(int pass) const
+    {
+        int count = std::min((int)resultFrames, HISTORY_SIZE);
+        float sum = 0.0f;
+        for (int i = 0; i < count; i++)
+            sum += GetPassHistory(pass, i);
+        return count > 0 ? sum / count : 0.0f;
+    }
+    const std::string& GetPassName(int pass) const { return passes[pass].name; }
+    int GetPassCount() const { return (int)passes.size(); }
+    // Sum of the outermost passes of the latest frame with results
+    float GetFrameTime() const { return frameTime; }
+    // Number of frames whose results have been read, changes when new times are available
+    unsigned int GetResultFrames() const { return resultFrames; }
+
+    // Writes the history as CSV, one column per pass and one row per frame from oldest to newest
+    bool ExportHistory(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("GpuProfiler", "Could not open %s", path.c_str());
+            return false;
+        }
+
+        file << "frame";
+        for (auto& pass : passes)
+            file << "," << pass.name;
+        file << "\n";
+
+        int count = std::min((int)resultFrames, HISTORY_SIZE);
+        for (int i = count - 1; i >= 0; i--)
+        {
+            file << resultFrames - i;
+            for (int pass = 0; pass < (int)passes.size(); pass++)
+                file << "," << GetPassHistory(pass, i);
+            file << "\n";
+        }
+        return true;
+    }
+
+    void deleteGpuProfiler()
+    {
+        for (auto& frame : frames)
+            glDeleteQueries((int)frame.queries.size(), frame.queries.data());
+    }
+
+private:
+    struct Pass
+    {
+        std::string name;
+        float time = 0.0f;
+        std::vector<float> history;
+    };
+
+    struct Frame
+    {
+        std::vector<unsigned int> queries;
+        std::vector<bool> issued;
+        std::vector<int> depth;
+        unsigned int lastTimestamp = 0;
+    };
+
+    std::vector<Pass> passes;
+    Frame frames[FRAME_LATENCY];
+    int frameIndex = 0;
+    int depth = 0;
+    int historyIndex = 0;
+    float frameTime = 0.0f;
+    unsigned int resultFrames = 0;
+};
+
+#endif //OPENGL_GAMEENGINE_GPUPROFILER_HPP
@@ -0,0 +1,353 @@
+#ifndef OPENGL_GAMEENGINE_JOBSYSTEM_HPP
+#define OPENGL_GAMEENGINE_JOBSYSTEM_HPP
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <iterator>
+#include <functional>
+#include <condition_variable>
+#include <algorithm>
+#include <string>
+#include "Engine/Profiler.hpp"
+
+class JobSystem;
+
+// Number of unfinished jobs started with it. Jobs can be made to wait for a counter, they are queued once it reaches zero.
+// A counter may only be destroyed after JobSystem::Wait returned for it.
+class JobCounter
+{
+public:
+    bool IsDone() const { return _value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Job
+    {
+        std::function<void()> function;
+        JobCounter* counter;
+    };
+
+    std::atomic<int> _value{0};
+    // Orders the last decrement against jobs added as continuations and against Wait returning
+    mutable std::mutex _mutex;
+    std::vector<Job> _continuations;
+};
+
+// Work stealing job system. Every worker owns a deque, it runs its own jobs newest first and steals the oldest job
+// of another deque when it runs dry. Threads outside the system push to a shared deque and help while they wait.
+// Jobs touching GL are queued separately and run by the thread owning the context, see RunGLJobs.
+class JobSystem
+{
+public:
+    using Job = JobCounter::Job;
+
+    static JobSystem& GetInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    explicit JobSystem(unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1)
+    {
+        // Deque 0 is shared by the threads outside the system
+        for (unsigned int i = 0; i <= workerCount; i++)
+            _queues.push_back(std::make_unique<Queue>());
+        for (unsigned int i = 0; i < workerCount; i++)
+        {
+            _workers.emplace_back([this, i]() {
+                Profiler::SetThreadName("Worker " + std::to_string(i));
+                _queueIndex = i + 1;
+                _owner = this;
+                WorkerLoop();
+            });
+        }
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    // Worker threads plus the calling thread
+    unsigned int GetThreadCount() const { return (unsigned int)_workers.size() + 1; }
+
+    // Queues the job, the counter is incremented now and decremented once the job has finished
+    void Run(std::function<void()> function, JobCounter* counter = nullptr)
+    {
+        if (counter != nullptr)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        Push({std::move(function), counter});
+    }
+
+    // Queues the job once every job of the dependency has finished
+    void Run(std::function<void()> function, JobCounter& dependency, JobCounter* counter = nullptr)
+    {
+        if (counter != nullptr)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(dependency._mutex);
+            if (!dependency.IsDone())
+            {
+                dependency._continuations.push_back({std::move(function), counter});
+                return;
+            }
+        }
+        Push({std::move(function), counter});
+    }
+
+    // Runs queued jobs on the calling thread until the counter reaches zero
+    void Wait(const JobCounter& counter)
+    {
+        while (!counter.IsDone())
+        {
+            Job job;
+            if (TryPop(job))
+                Execute(job);
+            else
+                std::this_thread::yield();
+        }
+        // The thread that finished the last job may still hold the lock, the counter has to outlive it
+        std::lock_guard<std::mutex> lock(counter._mutex);
+    }
+
+    // Calls function(begin, end) for chunks of [0, count), the calling thread takes part and the call blocks until all chunks are done
+    template<typename Function>
+    void ParallelFor(int count, int chunkSize, Function&& function)
+    {
+        int chunkCount = (count + chunkSize - 1) / chunkSize;
+        int helperCount = std::min((int)_workers.size(), chunkCount - 1);
+        if (helperCount <= 0)
+        {
+            if (count > 0)
+                function(0, count);
+            return;
+        }
+
+        // Helpers claim chunks until none are left, so a helper that starts late costs nothing
+        std::atomic<int> nextChunk{0};
+        auto processChunks = [&]() {
+            int chunk;
+            while ((chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount)
+            {
+                function(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+            }
+        };
+
+        // A single reference fits into std::function without allocating
+        JobCounter counter;
+        for (int i = 0; i < helperCount; i++)
+            Run([&processChunks]() { processChunks(); }, &counter);
+        processChunks();
+
+        // Helpers reference this stack frame, wait until every one of them has left
+        Wait(counter);
+    }
+
+    // Calls function(element) for every element of [begin, end), for containers without random access such as plf::colony
+    template<typename Iterator, typename Function>
+    void ParallelFor(Iterator begin, Iterator end, int chunkSize, Function&& function)
+    {
+        std::vector<Iterator> chunkStarts;
+        int count = (int)std::distance(begin, end);
+        for (int i = 0; i < count; i += chunkSize)
+        {
+            chunkStarts.push_back(begin);
+            std::advance(begin, std::min(chunkSize, count - i));
+        }
+        chunkStarts.push_back(end);
+
+        ParallelFor((int)chunkStarts.size() - 1, 1, [&](int firstChunk, int lastChunk) {
+            for (int chunk = firstChunk; chunk < lastChunk; chunk++)
+            {
+                for (Iterator it = chunkStarts[chunk]; it != chunkStarts[chunk + 1]; ++it)
+                    function(*it);
+            }
+        });
+    }
+
+    // Queues a job for the thread owning the GL context
+    void RunOnGLThread(std::function<void()> function, JobCounter* counter = nullptr)
+    {
+        if (counter != nullptr)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(_glMutex);
+        _glJobs.push_back({std::move(function), counter});
+    }
+
+    // Runs the queued GL jobs, called once per frame by the thread owning the GL context
+    void RunGLJobs()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_glMutex);
+            std::swap(_glJobs, _runningGLJobs);
+        }
+        for (auto& job : _runningGLJobs)
+            Execute(job);
+        _runningGLJobs.clear();
+    }
+
+private:
+    // Ring buffer of jobs, it grows when full and keeps its size, so queuing does not allocate once warmed up
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t head = 0;
+        size_t count = 0;
+
+        void PushBack(Job job)
+        {
+            if (count == jobs.size())
+            {
+                std::vector<Job> grown(std::max<size_t>(16, jobs.size() * 2));
+                for (size_t i = 0; i < count; i++)
+                    grown[i] = std::move(jobs[(head + i) % jobs.size()]);
+                jobs.swap(grown);
+                head = 0;
+            }
+            jobs[(head + count++) % jobs.size()] = std::move(job);
+        }
+
+        bool PopBack(Job& job)
+        {
+            if (count == 0)
+                return false;
+            Take(jobs[(head + --count) % jobs.size()], job);
+            return true;
+        }
+
+        bool PopFront(Job& job)
+        {
+            if (count == 0)
+                return false;
+            Take(jobs[head], job);
+            head = (head + 1) % jobs.size();
+            count--;
+            return true;
+        }
+
+        // Leaves the slot empty so the captures of the job are not kept alive
+        static void Take(Job& slot, Job& job)
+        {
+            job = std::move(slot);
+            slot.function = nullptr;
+        }
+    };
+
+    void Push(Job job)
+    {
+        // Threads of other job systems share this one's external deque
+        unsigned int index = _owner == this ? _queueIndex : 0;
+        {
+            Queue& queue = *_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.PushBack(std::move(job));
+        }
+        _queuedJobs.fetch_add(1);
+        if (_sleepingWorkers.load() > 0)
+        {
+            // Taking the lock orders the push before a worker that is about to sleep checks for jobs
+            { std::lock_guard<std::mutex> lock(_sleepMutex); }
+            _wake.notify_one();
+        }
+    }
+
+    // Newest job of the own deque, otherwise the oldest job of another one
+    bool TryPop(Job& job)
+    {
+        if (_queuedJobs.load(std::memory_order_relaxed) <= 0)
+            return false;
+
+        unsigned int ownIndex = _owner == this ? _queueIndex : 0;
+        {
+            Queue& queue = *_queues[ownIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.PopBack(job))
+            {
+                _queuedJobs.fetch_sub(1);
+                return true;
+            }
+        }
+
+        unsigned int queueCount = (unsigned int)_queues.size();
+        for (unsigned int i = 1; i < queueCount; i++)
+        {
+            Queue& queue = *_queues[(ownIndex + i) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.PopFront(job))
+            {
+                _queuedJobs.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Execute(Job& job)
+    {
+        job.function();
+        JobCounter* counter = job.counter;
+        if (counter == nullptr)
+            return;
+
+        // The last job of the counter releases the jobs waiting for it. They are queued under the lock, so the
+        // continuations keep their capacity, and Wait can not return for the counter before they are all queued.
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        if (counter->_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            for (auto& continuation : counter->_continuations)
+                Push(std::move(continuation));
+            counter->_continuations.clear();
+        }
+    }
+
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            Job job;
+            if (TryPop(job))
+            {
+                PROFILE_ZONE("Job");
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _sleepingWorkers.fetch_add(1);
+            _wake.wait(lock, [this]() { return _stopping || _queuedJobs.load() > 0; });
+            _sleepingWorkers.fetch_sub(1);
+            if (_stopping && _queuedJobs.load() <= 0)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<int> _queuedJobs{0};
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<int> _sleepingWorkers{0};
+    bool _stopping = false;
+
+    std::mutex _glMutex;
+    std::vector<Job> _glJobs;
+    std::vector<Job> _runningGLJobs;
+
+    // Deque of the calling thread, only meaningful when _owner is this system
+    inline static thread_local unsigned int _queueIndex = 0;
+    inline static thread_local JobSystem* _owner = nullptr;
+};
+
+#endif //OPENGL_GAMEENGINE_JOBSYSTEM_HPP
@@ -0,0 +1,99 @@
+#ifndef OPENGL_GAMEENGINE_LIGHTVOLUMEMESH_HPP
+#define OPENGL_GAMEENGINE_LIGHTVOLUMEMESH_HPP
+
+#include <glad/glad.h>
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "Engine/VAO.hpp"
+#include "Engine/VBO.hpp"
+#include "Engine/EBO.hpp"
+
+// Closed mesh drawn around a local light in the light volume pass.
+// The meshes enclose their unit shape, the sphere has radius 1 and the cone has its apex
+// in the origin and a base of radius 1 at z = 1.
+class LightVolumeMesh
+{
+public:
+    static LightVolumeMesh Sphere(int segments = 16, int rings = 12)
+    {
+        // Pushed out so the flat faces stay outside of the unit sphere
+        float scale = 1.0f / (std::cos(glm::pi<float>() / segments) * std::cos(glm::pi<float>() / (2.0f * rings)));
+
+        std::vector<Vertex> vertices;
+        for (int ring = 0; ring <= rings; ring++)
+        {
+            float phi = glm::pi<float>() * ring / rings;
+            for (int segment = 0; segment <= segments; segment++)
+            {
+                float theta = 2.0f * glm::pi<float>() * segment / segments;
+                glm::vec3 position = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+                vertices.push_back({position * scale, position, glm::vec2(0.0f)});
+            }
+        }
+
+        std::vector<unsigned int> indices;
+        for (int ring = 0; ring < rings; ring++)
+        {
+            for (int segment = 0; segment < segments; segment++)
+            {
+                unsigned int current = ring * (segments + 1) + segment;
+                unsigned int below = current + segments + 1;
+                indices.insert(indices.end(), {current, current + 1, below, below, current + 1, below + 1});
+            }
+        }
+        return LightVolumeMesh(vertices, indices);
+    }
+
+    static LightVolumeMesh Cone(int segments = 16)
+    {
+        float scale = 1.0f / std::cos(glm::pi<float>() / segments);
+
+        std::vector<Vertex> vertices;
+        vertices.push_back({glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.0f)});
+        vertices.push_back({glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)});
+        for (int segment = 0; segment < segments; segment++)
+        {
+            float theta = 2.0f * glm::pi<float>() * segment / segments;
+            glm::vec3 position = glm::vec3(std::cos(theta) * scale, std::sin(theta) * scale, 1.0f);
+            vertices.push_back({position, glm::normalize(position), glm::vec2(0.0f)});
+        }
+
+        std::vector<unsigned int> indices;
+        for (int segment = 0; segment < segments; segment++)
+        {
+            unsigned int current = 2 + segment;
+            unsigned int next = 2 + (segment + 1) % segments;
+            // Side and base
+            indices.insert(indices.end(), {0u, next, current});
+            indices.insert(indices.end(), {1u, current, next});
+        }
+        return LightVolumeMesh(vertices, indices);
+    }
+
+    void draw()
+    {
+        vao.bind();
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        vao.unbind();
+    }
+
+private:
+    LightVolumeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) :
+        vbo(vertices), ebo(indices), indexCount((int)indices.size())
+    {
+        vao.bind();
+        vao.linkAttribPointer(vbo, 0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        ebo.bind();
+        vao.unbind();
+        ebo.unbind();
+    }
+
+    VAO vao;
+    VBO vbo;
+    EBO ebo;
+    int indexCount;
+};
+
+#endif //OPENGL_GAMEENGINE_LIGHTVOLUMEMESH_HPP
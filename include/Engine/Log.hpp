@@ -0,0 +1,208 @@
+#ifndef OPENGL_GAMEENGINE_LOG_HPP
+#define OPENGL_GAMEENGINE_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+
+// Asynchronous logging. The calling thread formats the message into a slot of a lock-free ring buffer,
+// a background thread adds the time, severity and category and writes it out, so logging never waits on stdout.
+// When the buffer is full the message is dropped and counted instead of blocking. Errors are the exception, the
+// calling thread waits until they are written, as they often come right before the process goes down.
+//
+//     LOG_INFO("Shader", "Compiled %s", path.c_str());
+//
+// Categories must outlive the logger, string literals are stored by pointer.
+
+#define LOG_DEBUG(category, ...) Log::Write(LogLevel::DEBUG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) Log::Write(LogLevel::INFO, category, __VA_ARGS__)
+#define LOG_WARNING(category, ...) Log::Write(LogLevel::WARNING, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) Log::Write(LogLevel::ERROR, category, __VA_ARGS__)
+
+enum class LogLevel
+{
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+class Log
+{
+public:
+    static constexpr uint32_t CAPACITY = 1024;      // Messages in flight, a power of two
+    static constexpr uint32_t MESSAGE_SIZE = 512;   // Longer messages are truncated
+
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    static void Write(LogLevel level, const char* category, const char* format, ...)
+    {
+        Log& log = GetInstance();
+        if (level < log.minLevel.load(std::memory_order_relaxed))
+            return;
+
+        // Draining first makes room, so an error is not dropped with a full buffer
+        if (level == LogLevel::ERROR)
+            Flush();
+
+        va_list arguments;
+        va_start(arguments, format);
+        log.Push(level, category, format, arguments);
+        va_end(arguments);
+
+        if (level == LogLevel::ERROR)
+            Flush();
+    }
+
+    // Messages below the level are discarded at the call site
+    static void SetLevel(LogLevel level) { GetInstance().minLevel.store(level, std::memory_order_relaxed); }
+    static LogLevel GetLevel() { return GetInstance().minLevel.load(std::memory_order_relaxed); }
+
+    // Messages lost because the buffer was full
+    static uint64_t GetDroppedCount() { return GetInstance().dropped.load(std::memory_order_relaxed); }
+
+    // Waits until the background thread has written and flushed every message pushed so far, not meant for the frame loop
+    static void Flush()
+    {
+        Log& log = GetInstance();
+        uint64_t target = log.enqueuePosition.load(std::memory_order_acquire);
+        while (log.writtenPosition.load(std::memory_order_acquire) < target)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ~Log()
+    {
+        running.store(false, std::memory_order_release);
+        if (writer.joinable())
+            writer.join();
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        LogLevel level;
+        const char* category;
+        uint64_t time;
+        char text[MESSAGE_SIZE];
+    };
+
+    Log() : slots(new Slot[CAPACITY])
+    {
+        for (uint32_t i = 0; i < CAPACITY; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        writer = std::thread(&Log::WriteLoop, this);
+    }
+
+    static Log& GetInstance()
+    {
+        static Log log;
+        return log;
+    }
+
+    static uint64_t Now()
+    {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Bounded multi producer queue, a slot is free for position p when its sequence is p and readable when it is p + 1
+    void Push(LogLevel level, const char* category, const char* format, va_list arguments)
+    {
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true)
+        {
+            slot = &slots[position & (CAPACITY - 1)];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t difference = (int64_t)sequence - (int64_t)position;
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->category = category;
+        slot->time = Now();
+        std::vsnprintf(slot->text, MESSAGE_SIZE, format, arguments);
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    void WriteLoop()
+    {
+        uint64_t position = 0;
+        uint64_t reportedDropped = 0;
+        while (true)
+        {
+            // Read before draining, so every message pushed before the logger stopped is still written
+            bool stopping = !running.load(std::memory_order_acquire);
+
+            bool wrote = false;
+            while (true)
+            {
+                Slot& slot = slots[position & (CAPACITY - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+                    break;
+
+                WriteMessage(slot);
+                slot.sequence.store(position + CAPACITY, std::memory_order_release);
+                position++;
+                wrote = true;
+            }
+
+            uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+            if (droppedNow != reportedDropped)
+            {
+                std::fprintf(stdout, "[%10.3f] WARNING Log: %llu messages dropped, the buffer was full\n",
+                             Now() / 1000000.0, (unsigned long long)(droppedNow - reportedDropped));
+                reportedDropped = droppedNow;
+                wrote = true;
+            }
+
+            if (wrote)
+            {
+                std::fflush(stdout);
+                // Only after the flush, a flushed message survives the process crashing
+                writtenPosition.store(position, std::memory_order_release);
+            }
+            if (stopping)
+                return;
+            if (!wrote)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    static void WriteMessage(const Slot& slot)
+    {
+        static const char* levelNames[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+        std::fprintf(stdout, "[%10.3f] %-7s %s: %s\n", slot.time / 1000000.0, levelNames[(int)slot.level],
+                     slot.category, slot.text);
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> enqueuePosition{0};
+    std::atomic<uint64_t> writtenPosition{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<LogLevel> minLevel{LogLevel::INFO};
+    std::atomic<bool> running{true};
+    std::thread writer;
+};
+
+#endif //OPENGL_GAMEENGINE_LOG_HPP
@@ -0,0 +1,173 @@
+#ifndef OPENGL_GAMEENGINE_OBJECTPOOL_HPP
+#define OPENGL_GAMEENGINE_OBJECTPOOL_HPP
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <utility>
+#include <atomic>
+
+// Reference to an object of an ObjectPool. The generation changes whenever the slot is freed, so a handle to a
+// destroyed object resolves to nullptr instead of whatever reuses the slot.
+template<typename T>
+struct Handle
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t index = NONE;
+    uint32_t generation = 0;
+
+    bool IsNull() const { return index == NONE; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Lets a PoolSet free objects without knowing their type
+class PoolBase
+{
+public:
+    virtual ~PoolBase() = default;
+    virtual void Destroy(uint32_t index, uint32_t generation) = 0;
+};
+
+// Objects of one type in cache line aligned blocks that are never moved or freed, so pointers stay valid until the
+// object is destroyed. Creating and destroying reuse freed slots and only allocate when every block is full.
+template<typename T>
+class ObjectPool : public PoolBase
+{
+public:
+    static constexpr uint32_t BLOCK_SIZE = 64;
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ~ObjectPool() override
+    {
+        for (uint32_t index = 0; index < (uint32_t)_alive.size(); index++)
+        {
+            if (_alive[index])
+                GetObject(index)->~T();
+        }
+    }
+
+    template<typename... Args>
+    Handle<T> Create(Args&&... args)
+    {
+        if (_freeSlots.empty())
+            AddBlock();
+        uint32_t index = _freeSlots.back();
+        _freeSlots.pop_back();
+
+        new (GetObject(index)) T(std::forward<Args>(args)...);
+        _alive[index] = 1;
+        _count++;
+        return {index, _generations[index]};
+    }
+
+    void Destroy(Handle<T> handle)
+    {
+        Destroy(handle.index, handle.generation);
+    }
+
+    void Destroy(uint32_t index, uint32_t generation) override
+    {
+        if (!IsAlive(index, generation))
+            return;
+
+        GetObject(index)->~T();
+        _alive[index] = 0;
+        _generations[index]++;
+        _freeSlots.push_back(index);
+        _count--;
+    }
+
+    // nullptr once the object was destroyed
+    T* Get(Handle<T> handle)
+    {
+        return IsAlive(handle.index, handle.generation) ? GetObject(handle.index) : nullptr;
+    }
+
+    int GetCount() const { return _count; }
+    int GetCapacity() const { return (int)_alive.size(); }
+
+    // Calls function(object) for every live object in slot order
+    template<typename Function>
+    void ForEach(Function&& function)
+    {
+        for (uint32_t index = 0; index < (uint32_t)_alive.size(); index++)
+        {
+            if (_alive[index])
+                function(*GetObject(index));
+        }
+    }
+
+private:
+    struct alignas(64) Block
+    {
+        alignas(T) unsigned char storage[BLOCK_SIZE * sizeof(T)];
+    };
+
+    bool IsAlive(uint32_t index, uint32_t generation) const
+    {
+        return index < _alive.size() && _alive[index] && _generations[index] == generation;
+    }
+
+    T* GetObject(uint32_t index)
+    {
+        return reinterpret_cast<T*>(_blocks[index / BLOCK_SIZE]->storage + (index % BLOCK_SIZE) * sizeof(T));
+    }
+
+    void AddBlock()
+    {
+        uint32_t first = (uint32_t)_alive.size();
+        _blocks.emplace_back(new Block);
+        _alive.resize(first + BLOCK_SIZE, 0);
+        _generations.resize(first + BLOCK_SIZE, 0);
+        // Reversed so the lowest slots are used first
+        for (uint32_t index = first + BLOCK_SIZE; index > first; index--)
+            _freeSlots.push_back(index - 1);
+    }
+
+    std::vector<std::unique_ptr<Block>> _blocks;
+    std::vector<uint8_t> _alive;
+    std::vector<uint32_t> _generations;
+    std::vector<uint32_t> _freeSlots;
+    int _count = 0;
+};
+
+// One pool per type, created on first use
+class PoolSet
+{
+public:
+    template<typename T>
+    ObjectPool<T>& Get()
+    {
+        int id = GetTypeId<T>();
+        if (id >= (int)_pools.size())
+            _pools.resize(id + 1);
+        if (!_pools[id])
+            _pools[id] = std::make_unique<ObjectPool<T>>();
+        return static_cast<ObjectPool<T>&>(*_pools[id]);
+    }
+
+    // Frees an object created by the pool of the type id, see GetTypeId
+    void Destroy(int typeId, uint32_t index, uint32_t generation)
+    {
+        _pools[typeId]->Destroy(index, generation);
+    }
+
+    template<typename T>
+    static int GetTypeId()
+    {
+        static const int id = _typeCount++;
+        return id;
+    }
+
+private:
+    std::vector<std::unique_ptr<PoolBase>> _pools;
+    inline static std::atomic<int> _typeCount{0};
+};
+
+#endif //OPENGL_GAMEENGINE_OBJECTPOOL_HPP
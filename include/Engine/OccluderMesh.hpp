@@ -0,0 +1,144 @@
+#ifndef OPENGL_GAMEENGINE_OCCLUDERMESH_HPP
+#define OPENGL_GAMEENGINE_OCCLUDERMESH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <limits>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Engine/Bounds.hpp"
+
+// Low polygon stand-in of a model that is rasterized into the CPU occlusion buffer
+struct OccluderMesh
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<unsigned int> indices;
+
+    size_t GetTriangleCount() const { return indices.size() / 3; }
+
+    // Vertex clustering on a uniform grid over the bounds, the meshes only need vertices with a position and indices.
+    // An occluder that sticks out of the model hides objects that are visible, so each cell collapses onto its vertex
+    // furthest behind the cell's surface and is moved back by the cell's extent along the surface normal. The result
+    // stays inside the model as long as the surface does not fold back within a cell. Front faces are counter-clockwise,
+    // as the renderer culls them. Cells whose triangles face opposite ways, like both sides of a thin wall, have no
+    // inside and the triangles touching them are dropped.
+    template<typename MeshList>
+    static OccluderMesh Simplify(const MeshList& meshes, const AABB& bounds, int gridResolution)
+    {
+        OccluderMesh occluder;
+        if (!bounds.IsValid())
+            return occluder;
+
+        gridResolution = std::clamp(gridResolution, 1, 64);
+        glm::vec3 cellSize = glm::max((bounds.max - bounds.min) / (float)gridResolution, glm::vec3(1e-5f));
+
+        struct Cell
+        {
+            glm::vec3 normalSum = glm::vec3(0.0f);
+            float area = 0.0f;
+            glm::vec3 deepest = glm::vec3(0.0f);
+            float deepestDistance = std::numeric_limits<float>::max();
+            int vertex = -1;    // Index in the occluder once a triangle uses the cell
+        };
+        std::unordered_map<uint32_t, unsigned int> cellIndices;
+        std::vector<Cell> cells;
+        std::vector<std::vector<unsigned int>> remaps;
+
+        // Area weighted face normals of every cell's triangles, an inconsistent winding cancels out like a thin wall
+        for (auto& mesh : meshes)
+        {
+            std::vector<unsigned int>& remap = remaps.emplace_back(mesh.vertices.size());
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+            {
+                glm::ivec3 cell = glm::ivec3((mesh.vertices[i].position - bounds.min) / cellSize);
+                cell = glm::clamp(cell, glm::ivec3(0), glm::ivec3(gridResolution - 1));
+                uint32_t cellKey = (uint32_t)((cell.z * gridResolution + cell.y) * gridResolution + cell.x);
+                auto it = cellIndices.emplace(cellKey, (unsigned int)cells.size()).first;
+                if (it->second == cells.size())
+                    cells.emplace_back();
+                remap[i] = it->second;
+            }
+
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+            {
+                const glm::vec3& a = mesh.vertices[mesh.indices[i]].position;
+                const glm::vec3& b = mesh.vertices[mesh.indices[i + 1]].position;
+                const glm::vec3& c = mesh.vertices[mesh.indices[i + 2]].position;
+                glm::vec3 areaNormal = glm::cross(b - a, c - a);
+                float area = glm::length(areaNormal);
+                for (int j = 0; j < 3; j++)
+                {
+                    Cell& cell = cells[remap[mesh.indices[i + j]]];
+                    cell.normalSum += areaNormal;
+                    cell.area += area;
+                }
+            }
+        }
+
+        for (size_t m = 0; m < remaps.size(); m++)
+        {
+            auto& vertices = meshes[m].vertices;
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                Cell& cell = cells[remaps[m][i]];
+                if (!HasInside(cell.normalSum, cell.area))
+                    continue;
+                float distance = glm::dot(vertices[i].position, glm::normalize(cell.normalSum));
+                if (distance < cell.deepestDistance)
+                {
+                    cell.deepestDistance = distance;
+                    cell.deepest = vertices[i].position;
+                }
+            }
+        }
+
+        std::unordered_set<uint64_t> addedTriangles;
+        for (size_t m = 0; m < remaps.size(); m++)
+        {
+            auto& indices = meshes[m].indices;
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                unsigned int triangle[3] = {remaps[m][indices[i]], remaps[m][indices[i + 1]], remaps[m][indices[i + 2]]};
+                if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                    continue;
+                if (!HasInside(cells[triangle[0]].normalSum, cells[triangle[0]].area) ||
+                    !HasInside(cells[triangle[1]].normalSum, cells[triangle[1]].area) ||
+                    !HasInside(cells[triangle[2]].normalSum, cells[triangle[2]].area))
+                    continue;
+
+                // Collapsed cells produce many duplicates, the rasterizer does not care about winding
+                unsigned int sorted[3] = {triangle[0], triangle[1], triangle[2]};
+                std::sort(sorted, sorted + 3);
+                uint64_t triangleKey = ((uint64_t)sorted[0] << 42) | ((uint64_t)sorted[1] << 21) | (uint64_t)sorted[2];
+                if (!addedTriangles.insert(triangleKey).second)
+                    continue;
+
+                for (unsigned int cellIndex : triangle)
+                {
+                    Cell& cell = cells[cellIndex];
+                    if (cell.vertex < 0)
+                    {
+                        glm::vec3 normal = glm::normalize(cell.normalSum);
+                        cell.vertex = (int)occluder.vertices.size();
+                        occluder.vertices.push_back(cell.deepest - normal * glm::dot(glm::abs(normal), cellSize));
+                    }
+                    occluder.indices.push_back((unsigned int)cell.vertex);
+                }
+            }
+        }
+
+        return occluder;
+    }
+
+    // Whether the triangles of a cell agree on a side, the summed normal is short when they face opposite ways
+    static bool HasInside(const glm::vec3& normalSum, float area)
+    {
+        return area > 0.0f && glm::length(normalSum) >= MIN_NORMAL_AGREEMENT * area;
+    }
+
+    static constexpr float MIN_NORMAL_AGREEMENT = 0.5f;
+};
+
+#endif //OPENGL_GAMEENGINE_OCCLUDERMESH_HPP
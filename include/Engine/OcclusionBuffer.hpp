@@ -0,0 +1,378 @@
+#ifndef OPENGL_GAMEENGINE_OCCLUSIONBUFFER_HPP
+#define OPENGL_GAMEENGINE_OCCLUSIONBUFFER_HPP
+
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Engine/Bounds.hpp"
+#include "Engine/OccluderMesh.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/FrameAllocator.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_BUFFER_SSE
+#include <emmintrin.h>
+#endif
+
+// Low resolution software depth buffer for CPU occlusion culling.
+// Occluders are rasterized in horizontal bands on the job system, four pixels at a time,
+// and the per tile maximum depth gives a hierarchical early out for the visibility tests.
+// Depth is stored as window depth in [0, 1], cleared to the far plane.
+class OcclusionBuffer
+{
+public:
+    static constexpr int TILE_SIZE = 8;
+
+    struct Statistics
+    {
+        int occluders = 0;
+        int triangles = 0;
+        std::atomic<int> testedObjects{0};
+        std::atomic<int> occludedObjects{0};
+    };
+
+    OcclusionBuffer() : OcclusionBuffer(256, 128) {};
+
+    OcclusionBuffer(int width, int height)
+    {
+        Resize(width, height);
+    }
+
+    // The size is rounded up to whole tiles
+    void Resize(int width, int height)
+    {
+        _tilesX = std::max(1, (width + TILE_SIZE - 1) / TILE_SIZE);
+        _tilesY = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+        _width = _tilesX * TILE_SIZE;
+        _height = _tilesY * TILE_SIZE;
+        _depth.assign(_width * _height, 1.0f);
+        _tileMaxDepth.assign(_tilesX * _tilesY, 1.0f);
+    }
+
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+    const float* GetDepth() const { return _depth.data(); }
+    const Statistics& GetStatistics() const { return _statistics; }
+
+    void Begin(const glm::mat4& viewProjection)
+    {
+        _viewProjection = viewProjection;
+        _occluders.clear();
+        _statistics.occluders = 0;
+        _statistics.triangles = 0;
+        _statistics.testedObjects = 0;
+        _statistics.occludedObjects = 0;
+    }
+
+    void AddOccluder(const OccluderMesh* occluder, const glm::mat4& model)
+    {
+        if (occluder != nullptr && !occluder->indices.empty())
+            _occluders.push_back({occluder, _viewProjection * model});
+    }
+
+    void Rasterize(JobSystem& jobSystem)
+    {
+        // Transform, clip and set up the triangles of every occluder
+        if (_occluderTriangles.size() < _occluders.size())
+            _occluderTriangles.resize(_occluders.size());
+        jobSystem.ParallelFor((int)_occluders.size(), 4, [this](int begin, int end) {
+            for (int i = begin; i < end; i++)
+                SetupTriangles(_occluders[i], _occluderTriangles[i]);
+        });
+
+        _statistics.occluders = (int)_occluders.size();
+        for (size_t i = 0; i < _occluders.size(); i++)
+            _statistics.triangles += (int)_occluderTriangles[i].size();
+
+        // Each band of tile rows is owned by one thread, so no synchronization is needed
+        jobSystem.ParallelFor(_tilesY, 1, [this](int begin, int end) {
+            for (int tileRow = begin; tileRow < end; tileRow++)
+                RasterizeBand(tileRow);
+        });
+    }
+
+    // Conservative test, false only if the bounds are fully hidden behind the rasterized occluders
+    bool IsVisible(const AABB& bounds)
+    {
+        _statistics.testedObjects++;
+
+        glm::vec2 screenMin = glm::vec2(std::numeric_limits<float>::max());
+        glm::vec2 screenMax = glm::vec2(-std::numeric_limits<float>::max());
+        float minDepth = 1.0f;
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec3 corner = glm::vec3(i & 1 ? bounds.max.x : bounds.min.x,
+                                         i & 2 ? bounds.max.y : bounds.min.y,
+                                         i & 4 ? bounds.max.z : bounds.min.z);
+            glm::vec4 clip = _viewProjection * glm::vec4(corner, 1.0f);
+            // Crossing the near plane, treat as visible
+            if (clip.w <= NEAR_EPSILON || clip.z < -clip.w)
+                return true;
+
+            glm::vec3 window = ClipToWindow(clip);
+            screenMin = glm::min(screenMin, glm::vec2(window.x, window.y));
+            screenMax = glm::max(screenMax, glm::vec2(window.x, window.y));
+            minDepth = std::min(minDepth, window.z);
+        }
+
+        int x0 = std::max(0, (int)std::floor(screenMin.x));
+        int y0 = std::max(0, (int)std::floor(screenMin.y));
+        int x1 = std::min(_width - 1, (int)std::floor(screenMax.x));
+        int y1 = std::min(_height - 1, (int)std::floor(screenMax.y));
+        if (x0 > x1 || y0 > y1)
+        {
+            _statistics.occludedObjects++;
+            return false;
+        }
+
+        for (int tileY = y0 / TILE_SIZE; tileY <= y1 / TILE_SIZE; tileY++)
+        {
+            for (int tileX = x0 / TILE_SIZE; tileX <= x1 / TILE_SIZE; tileX++)
+            {
+                if (minDepth > _tileMaxDepth[tileY * _tilesX + tileX])
+                    continue;
+
+                // The tile is not fully in front, check the covered pixels
+                int pixelY0 = std::max(y0, tileY * TILE_SIZE);
+                int pixelY1 = std::min(y1, tileY * TILE_SIZE + TILE_SIZE - 1);
+                int pixelX0 = std::max(x0, tileX * TILE_SIZE);
+                int pixelX1 = std::min(x1, tileX * TILE_SIZE + TILE_SIZE - 1);
+                for (int y = pixelY0; y <= pixelY1; y++)
+                {
+                    const float* row = &_depth[y * _width];
+                    for (int x = pixelX0; x <= pixelX1; x++)
+                    {
+                        if (minDepth <= row[x])
+                            return true;
+                    }
+                }
+            }
+        }
+
+        _statistics.occludedObjects++;
+        return false;
+    }
+
+private:
+    static constexpr float NEAR_EPSILON = 1e-5f;
+    static constexpr float EDGE_EPSILON = 1e-3f;
+
+    struct Occluder
+    {
+        const OccluderMesh* mesh;
+        glm::mat4 mvp;
+    };
+
+    // Edge functions and depth plane in window space, inside when all edges are non-negative
+    struct ScreenTriangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        int minX, minY, maxX, maxY;
+    };
+
+    glm::vec3 ClipToWindow(const glm::vec4& clip) const
+    {
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * (float)_width,
+                         (ndc.y * 0.5f + 0.5f) * (float)_height,
+                         ndc.z * 0.5f + 0.5f);
+    }
+
+    void SetupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles)
+    {
+        triangles.clear();
+        const OccluderMesh& mesh = *occluder.mesh;
+
+        // Frame memory, every job thread allocates from an arena of its own
+        FrameVector<glm::vec4> clipVertices(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+            clipVertices[i] = occluder.mvp * glm::vec4(mesh.vertices[i], 1.0f);
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            glm::vec4 polygon[4];
+            int vertexCount = ClipNear(clipVertices[mesh.indices[i]], clipVertices[mesh.indices[i + 1]],
+                                       clipVertices[mesh.indices[i + 2]], polygon);
+            if (vertexCount < 3)
+                continue;
+
+            glm::vec3 window[4];
+            for (int j = 0; j < vertexCount; j++)
+                window[j] = ClipToWindow(polygon[j]);
+
+            AddTriangle(window[0], window[1], window[2], triangles);
+            if (vertexCount == 4)
+                AddTriangle(window[0], window[2], window[3], triangles);
+        }
+    }
+
+    // Clips a triangle against the near plane (z >= -w), producing up to four vertices
+    static int ClipNear(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, glm::vec4* output)
+    {
+        const glm::vec4 input[3] = {a, b, c};
+        int count = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec4& current = input[i];
+            const glm::vec4& next = input[(i + 1) % 3];
+            float currentDistance = current.z + current.w;
+            float nextDistance = next.z + next.w;
+
+            if (currentDistance >= 0.0f)
+                output[count++] = current;
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+                output[count++] = current + (next - current) * t;
+            }
+        }
+        return count;
+    }
+
+    void AddTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, std::vector<ScreenTriangle>& triangles) const
+    {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (std::abs(area) < 1e-6f)
+            return;
+        if (area < 0.0f)
+        {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        ScreenTriangle triangle;
+        triangle.minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+        triangle.minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+        triangle.maxX = std::min(_width - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+        triangle.maxY = std::min(_height - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+            return;
+
+        const glm::vec3 vertices[3] = {v0, v1, v2};
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec3& from = vertices[i];
+            const glm::vec3& to = vertices[(i + 1) % 3];
+            // Normalized so the edge functions are pixel distances, shared edges get a small overlap instead of cracks
+            float length = std::sqrt((from.y - to.y) * (from.y - to.y) + (to.x - from.x) * (to.x - from.x));
+            triangle.edgeA[i] = (from.y - to.y) / length;
+            triangle.edgeB[i] = (to.x - from.x) / length;
+            triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y) + EDGE_EPSILON;
+        }
+
+        triangle.depthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.z - v0.z)) / area;
+        triangle.depthB = ((v1.x - v0.x) * (v2.z - v0.z) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+        triangle.depthC = v0.z - triangle.depthA * v0.x - triangle.depthB * v0.y;
+
+        triangles.push_back(triangle);
+    }
+
+    void RasterizeBand(int tileRow)
+    {
+        int yStart = tileRow * TILE_SIZE;
+        int yEnd = yStart + TILE_SIZE;
+        std::fill(_depth.begin() + yStart * _width, _depth.begin() + yEnd * _width, 1.0f);
+
+        for (size_t i = 0; i < _occluders.size(); i++)
+        {
+            for (auto& triangle : _occluderTriangles[i])
+            {
+                if (triangle.maxY < yStart || triangle.minY >= yEnd)
+                    continue;
+                RasterizeTriangle(triangle, std::max(yStart, triangle.minY), std::min(yEnd - 1, triangle.maxY));
+            }
+        }
+
+        // Hierarchical max depth of the band's tiles
+        for (int tileX = 0; tileX < _tilesX; tileX++)
+        {
+            float maxDepth = 0.0f;
+            for (int y = yStart; y < yEnd; y++)
+            {
+                const float* row = &_depth[y * _width + tileX * TILE_SIZE];
+                for (int x = 0; x < TILE_SIZE; x++)
+                    maxDepth = std::max(maxDepth, row[x]);
+            }
+            _tileMaxDepth[tileRow * _tilesX + tileX] = maxDepth;
+        }
+    }
+
+    void RasterizeTriangle(const ScreenTriangle& triangle, int y0, int y1)
+    {
+        // Start on a multiple of four, the width is a multiple of the tile size so the last group stays in the row
+        int x0 = triangle.minX & ~3;
+        int x1 = triangle.maxX;
+
+#ifdef OCCLUSION_BUFFER_SSE
+        const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+        const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+        const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+        const __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+        for (int y = y0; y <= y1; y++)
+        {
+            float pixelY = (float)y + 0.5f;
+            const __m128 row0 = _mm_set1_ps(triangle.edgeB[0] * pixelY + triangle.edgeC[0]);
+            const __m128 row1 = _mm_set1_ps(triangle.edgeB[1] * pixelY + triangle.edgeC[1]);
+            const __m128 row2 = _mm_set1_ps(triangle.edgeB[2] * pixelY + triangle.edgeC[2]);
+            const __m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelY + triangle.depthC);
+            float* depthRow = &_depth[y * _width];
+
+            for (int x = x0; x <= x1; x += 4)
+            {
+                __m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), pixelOffsets);
+                __m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), row0);
+                __m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), row1);
+                __m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), row2);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+                                           _mm_cmpge_ps(edge2, zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+                __m128 previous = _mm_loadu_ps(depthRow + x);
+                __m128 closer = _mm_min_ps(previous, depth);
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, previous)));
+            }
+        }
+#else
+        for (int y = y0; y <= y1; y++)
+        {
+            float pixelY = (float)y + 0.5f;
+            float* depthRow = &_depth[y * _width];
+            for (int x = x0; x <= x1; x++)
+            {
+                float pixelX = (float)x + 0.5f;
+                bool inside = true;
+                for (int i = 0; i < 3; i++)
+                    inside &= triangle.edgeA[i] * pixelX + triangle.edgeB[i] * pixelY + triangle.edgeC[i] >= 0.0f;
+                if (!inside)
+                    continue;
+
+                float depth = triangle.depthA * pixelX + triangle.depthB * pixelY + triangle.depthC;
+                depthRow[x] = std::min(depthRow[x], depth);
+            }
+        }
+#endif
+    }
+
+    int _width;
+    int _height;
+    int _tilesX;
+    int _tilesY;
+    std::vector<float> _depth;
+    std::vector<float> _tileMaxDepth;
+
+    glm::mat4 _viewProjection = glm::mat4(1.0f);
+    std::vector<Occluder> _occluders;
+    std::vector<std::vector<ScreenTriangle>> _occluderTriangles;
+    Statistics _statistics;
+};
+
+#endif //OPENGL_GAMEENGINE_OCCLUSIONBUFFER_HPP
@@ -0,0 +1,197 @@
+#ifndef OPENGL_GAMEENGINE_PROFILER_HPP
+#define OPENGL_GAMEENGINE_PROFILER_HPP
+
+#include <string>
+
+// CPU profiler with scoped zones, enabled by the ENGINE_PROFILING definition.
+// Without it the zone macros expand to nothing and the capture calls do nothing.
+//
+//     PROFILE_ZONE("Scene update");   // times the rest of the enclosing scope
+//     PROFILE_FUNCTION();             // same, named after the function
+//
+// Zone names must outlive the capture, string literals are stored by pointer.
+
+#ifdef ENGINE_PROFILING
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include "Engine/Log.hpp"
+#include <cstdint>
+#include "nlohmann/json.hpp"
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profilerZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+class Profiler
+{
+public:
+    // Events each thread can record during a capture, later ones are dropped
+    static constexpr uint32_t EVENTS_PER_THREAD = 1 << 16;
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) : name(name), start(IsCapturing() ? Now() : 0) {}
+        ~Zone()
+        {
+            if (start != 0)
+                Record(name, start, Now());
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+
+    // Starts recording, call it between frames so no zone of an older capture is still open
+    static void BeginCapture()
+    {
+        {
+            std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+            for (auto& buffer : GetRegistry().buffers)
+                buffer->count.store(0, std::memory_order_relaxed);
+        }
+        GetCapturing().store(true, std::memory_order_release);
+    }
+
+    static void EndCapture() { GetCapturing().store(false, std::memory_order_release); }
+    static bool IsCapturing() { return GetCapturing().load(std::memory_order_relaxed); }
+
+    // Name of the calling thread in the exported trace
+    static void SetThreadName(const std::string& name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+        buffer.name = name;
+    }
+
+    // Nanoseconds since the first call
+    static uint64_t Now()
+    {
+        static const auto epoch = std::chrono::steady_clock::now();
+        // Zero marks a zone that started outside of a capture
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+    }
+
+    // Writes the captured zones in the Chrome trace event format, opens in chrome://tracing and Perfetto
+    static bool ExportChromeTrace(const std::string& path)
+    {
+        nlohmann::json events = nlohmann::json::array();
+        {
+            std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+            for (auto& buffer : GetRegistry().buffers)
+            {
+                events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", buffer->id},
+                                  {"args", {{"name", buffer->name}}}});
+
+                uint32_t count = std::min(buffer->count.load(std::memory_order_acquire), EVENTS_PER_THREAD);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    const Event& event = buffer->events[i];
+                    events.push_back({{"name", event.name}, {"cat", "cpu"}, {"ph", "X"}, {"pid", 0}, {"tid", buffer->id},
+                                      {"ts", event.start / 1000.0}, {"dur", (event.end - event.start) / 1000.0}});
+                }
+            }
+        }
+
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Profiler", "Could not open %s", path.c_str());
+            return false;
+        }
+        nlohmann::json trace = {{"traceEvents", events}, {"displayTimeUnit", "ns"}};
+        file << trace.dump();
+        return true;
+    }
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Written only by its own thread, the count is published after the event so readers never see a partial one
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events = std::unique_ptr<Event[]>(new Event[EVENTS_PER_THREAD]);
+        std::atomic<uint32_t> count{0};
+        uint32_t id = 0;
+        std::string name;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    static void Record(const char* name, uint64_t start, uint64_t end)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        uint32_t index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= EVENTS_PER_THREAD)
+            return;
+        buffer.events[index] = {name, start, end};
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    // Registered once per thread, the buffers live until the program ends so exports can read finished threads
+    static ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.buffers.back().get();
+            buffer->id = (uint32_t)registry.buffers.size() - 1;
+            buffer->name = "Thread " + std::to_string(buffer->id);
+        }
+        return *buffer;
+    }
+
+    static Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    static std::atomic<bool>& GetCapturing()
+    {
+        static std::atomic<bool> capturing{false};
+        return capturing;
+    }
+};
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+
+class Profiler
+{
+public:
+    static void BeginCapture() {}
+    static void EndCapture() {}
+    static bool IsCapturing() { return false; }
+    static void SetThreadName(const std::string&) {}
+    static bool ExportChromeTrace(const std::string&) { return false; }
+};
+
+#endif
+
+#endif //OPENGL_GAMEENGINE_PROFILER_HPP
@@ -0,0 +1,49 @@
+#ifndef OPENGL_GAMEENGINE_SSBO_HPP
+#define OPENGL_GAMEENGINE_SSBO_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// Shader storage buffer, the storage only grows so per frame uploads do not reallocate
+class SSBO
+{
+public:
+    unsigned int ID;
+
+    SSBO()
+    {
+        glGenBuffers(1, &ID);
+    }
+
+    void SetData(const void* data, size_t size)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+        if (size > capacity || capacity == 0)
+        {
+            capacity = size > 0 ? size : 16;
+            glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, data, GL_DYNAMIC_DRAW);
+        }
+        else if (size > 0)
+        {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // Allocates at least size bytes without uploading anything
+    void Reserve(size_t size)
+    {
+        if (size > capacity)
+            SetData(nullptr, size);
+    }
+
+    size_t GetCapacity() const { return capacity; }
+
+    void bindBase(unsigned int binding) { glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ID); }
+    void deleteSSBO() { glDeleteBuffers(1, &ID); }
+
+private:
+    size_t capacity = 0;
+};
+
+#endif //OPENGL_GAMEENGINE_SSBO_HPP
\ No newline at end of file
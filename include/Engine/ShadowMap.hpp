@@ -3,10 +3,11 @@
 
 #include <glad/glad.h>
 #include <vector>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Engine/shader.hpp"
+#include "Engine/Bounds.hpp"
 #include <string>
 
 class ShadowMap
@@ -25,6 +26,9 @@ public:
         lightProjection = glm::ortho(-projectionSizeHalf, projectionSizeHalf, -projectionSizeHalf, projectionSizeHalf, nearPlane, farPlane);
         lightView = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
         lightVP = lightProjection * lightView;
+        lightDirection = glm::normalize(-lightPos);
+        casterFrustum = Frustum(lightVP);
+        casterFrustum.RemovePlane(Frustum::NEAR_PLANE);
 
         size = glm::vec2(width, height);
         glGenFramebuffers(1, &ID);
@@ -43,7 +47,7 @@ public:
 
         auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
         if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
-            std::cout<< "Shadow map error:" << fboStatus << std::endl;
+            LOG_ERROR("ShadowMap", "Shadow map error: 0x%x", fboStatus);
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
@@ -65,6 +69,11 @@ public:
         return size;
     }
 
+    // Light volume open towards the light, casters in front of the near plane are drawn with depth clamping
+    const Frustum& GetCasterFrustum() const { return casterFrustum; }
+    glm::vec3 GetLightDirection() const { return lightDirection; }
+    float GetShadowDistance() const { return farPlane - nearPlane; }
+
     void SetShadowUniforms(Shader& shader)
     {
         shader.bind();
@@ -100,6 +109,8 @@ private:
     glm::mat4 lightProjection;
     glm::mat4 lightView;
     glm::mat4 lightVP;
+    glm::vec3 lightDirection;
+    Frustum casterFrustum;
 };
 
 #endif //OPENGL_GAMEENGINE_SHADOWMAP_HPP
@@ -2,74 +2,48 @@
 #define OPENGL_GAMEENGINE_TRANSFORM_HPP
 
 #include "glm/glm.hpp"
-#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "Engine/TransformHierarchy.hpp"
 
+// Handle to a node of a TransformHierarchy, cheap to copy. Setting the local transform only marks the node dirty,
+// the model matrix is recomputed by the next hierarchy update or when it is read before that.
 class Transform{
 public:
-    void CalculateModelMatrix()
-    {
-        _modelMatrix = GetLocalMatrix();
-        _isUpdated = false;
-    }
-
-    void CalculateModelMatrix(glm::mat4& parentModelMatrix)
-    {
-        _modelMatrix = parentModelMatrix * GetLocalMatrix();
-        _isUpdated = false;
-    }
+    Transform() = default;
+    Transform(TransformHierarchy* hierarchy, int node) : _hierarchy(hierarchy), _node(node) {}
 
-    void SetModelMatrix(glm::mat4& modelMatrix)
+    // Places a root relative to an external matrix
+    void SetParentMatrix(const glm::mat4& parentMatrix)
     {
-        _modelMatrix = modelMatrix;
+        _hierarchy->SetParentMatrix(_node, parentMatrix);
     }
 
-    glm::mat4& GetModelMatrix() { return _modelMatrix; }
-    glm::vec3 GetLocalPosition() { return _position; }
-    glm::quat GetLocalRotation() { return  _rotation; }
-    glm::vec3 GetLocalScale() { return _scale; }
+    const glm::mat4& GetModelMatrix() { return _hierarchy->GetWorldMatrix(_node); }
+    const glm::mat3& GetNormalMatrix() { return _hierarchy->GetNormalMatrix(_node); }
+    glm::vec3 GetLocalPosition() { return _hierarchy->GetLocalPosition(_node); }
+    glm::quat GetLocalRotation() { return _hierarchy->GetLocalRotation(_node); }
+    glm::vec3 GetLocalScale() { return _hierarchy->GetLocalScale(_node); }
 
     void SetPosition(glm::vec3 newPosition)
     {
-        _isUpdated = true;
-        _position = newPosition;
+        _hierarchy->SetPosition(_node, newPosition);
     }
 
     void SetRotation(glm::quat newRotation)
     {
-        _isUpdated = true;
-        _rotation = newRotation;
+        _hierarchy->SetRotation(_node, newRotation);
     }
 
     void SetScale(glm::vec3 newScale)
     {
-        _isUpdated = true;
-        _scale = newScale;
+        _hierarchy->SetScale(_node, newScale);
     }
 
-    bool IsUpdated()
-    {
-        return _isUpdated;
-    }
+    int GetNode() { return _node; }
 
 private:
-    glm::mat4 GetLocalMatrix()
-    {
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), _position);
-
-        glm::mat4 rotation = glm::mat4_cast(_rotation);;
-
-        glm::mat4 scale = glm::scale(glm::mat4(1.0f), _scale);
-
-        return translation * rotation * scale;
-    }
-
-    glm::vec3 _position = {0.0f, 0.0f, 0.0f};
-    glm::quat _rotation = {0.0f, 0.0f, 0.0f, 0.0f};
-    glm::vec3 _scale = {1.0f, 1.0f, 1.0f};
-
-    glm::mat4 _modelMatrix = glm::mat4(1.0f);
-
-    bool _isUpdated = true;
+    TransformHierarchy* _hierarchy = nullptr;
+    int _node = TransformHierarchy::NONE;
 };
 
 #endif //OPENGL_GAMEENGINE_TRANSFORM_HPP
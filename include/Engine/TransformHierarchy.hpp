@@ -0,0 +1,421 @@
+#ifndef OPENGL_GAMEENGINE_TRANSFORMHIERARCHY_HPP
+#define OPENGL_GAMEENGINE_TRANSFORMHIERARCHY_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Profiler.hpp"
+
+// Local and world transforms of every node of a scene, stored as parallel arrays sorted by depth so that
+// parents always come before their children. Setters only mark the node dirty, Update then recomputes the
+// dirty nodes and everything below them one level at a time, the nodes of a level in parallel.
+//
+// Nodes are referred to by stable ids, their position in the arrays changes whenever the hierarchy is restructured.
+class TransformHierarchy
+{
+public:
+    static constexpr int NONE = -1;
+
+    int Create()
+    {
+        int node;
+        if (!_freeNodes.empty())
+        {
+            node = _freeNodes.back();
+            _freeNodes.pop_back();
+        }
+        else
+        {
+            node = (int)_indexOfNode.size();
+            _indexOfNode.push_back(NONE);
+        }
+
+        // New nodes are roots, appending a root keeps the arrays valid until the next reorder
+        int index = (int)_nodeOfIndex.size();
+        _indexOfNode[node] = index;
+        _nodeOfIndex.push_back(node);
+        _positions.emplace_back(0.0f);
+        _rotations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+        _scales.emplace_back(1.0f);
+        _parentMatrices.emplace_back(1.0f);
+        _worldMatrices.emplace_back(1.0f);
+        _normalMatrices.emplace_back(1.0f);
+        _parents.push_back(NONE);
+        _depths.push_back(0);
+        _dirty.push_back(1);
+        _changed.push_back(0);
+        _versions.push_back(0);
+        _parentVersions.push_back(0);
+        _anyDirty = true;
+        _orderChanged = true;
+        return node;
+    }
+
+    // The children become roots with the next update
+    void Destroy(int node)
+    {
+        int index = _indexOfNode[node];
+        _nodeOfIndex[index] = NONE;
+        _indexOfNode[node] = NONE;
+        _freeNodes.push_back(node);
+        _orderChanged = true;
+    }
+
+    void SetParent(int node, int parent)
+    {
+        int index = _indexOfNode[node];
+        _parents[index] = parent == NONE ? NONE : _indexOfNode[parent];
+        MarkDirty(index);
+        _orderChanged = true;
+    }
+
+    int GetParent(int node) const
+    {
+        int parentIndex = _parents[_indexOfNode[node]];
+        return parentIndex == NONE ? NONE : _nodeOfIndex[parentIndex];
+    }
+
+    void SetPosition(int node, const glm::vec3& position)
+    {
+        int index = _indexOfNode[node];
+        _positions[index] = position;
+        MarkDirty(index);
+    }
+
+    void SetRotation(int node, const glm::quat& rotation)
+    {
+        int index = _indexOfNode[node];
+        _rotations[index] = rotation;
+        MarkDirty(index);
+    }
+
+    void SetScale(int node, const glm::vec3& scale)
+    {
+        int index = _indexOfNode[node];
+        _scales[index] = scale;
+        MarkDirty(index);
+    }
+
+    // Matrix a root is placed relative to, for roots driven from outside the hierarchy. Ignored for nodes with a parent.
+    void SetParentMatrix(int node, const glm::mat4& parentMatrix)
+    {
+        int index = _indexOfNode[node];
+        _parentMatrices[index] = parentMatrix;
+        MarkDirty(index);
+    }
+
+    glm::vec3 GetLocalPosition(int node) const { return _positions[_indexOfNode[node]]; }
+    glm::quat GetLocalRotation(int node) const { return _rotations[_indexOfNode[node]]; }
+    glm::vec3 GetLocalScale(int node) const { return _scales[_indexOfNode[node]]; }
+
+    // Brings the node up to date first if it or one of its ancestors was changed since the last Update,
+    // only call it from one thread at a time unless the hierarchy is up to date
+    const glm::mat4& GetWorldMatrix(int node)
+    {
+        int index = _indexOfNode[node];
+        if (_anyDirty)
+            Resolve(index);
+        return _worldMatrices[index];
+    }
+
+    // Inverse transpose of the world matrix for transforming normals, cached like the world matrix
+    const glm::mat3& GetNormalMatrix(int node)
+    {
+        int index = _indexOfNode[node];
+        if (_anyDirty)
+            Resolve(index);
+        return _normalMatrices[index];
+    }
+
+    // Inverse transpose of the upper 3x3 of an affine matrix. The columns of the inverse transpose are the cross
+    // products of the other two columns divided by the determinant, much cheaper than a general 4x4 inverse.
+    static glm::mat3 CalculateNormalMatrix(const glm::mat4& matrix)
+    {
+        glm::vec3 x = glm::vec3(matrix[0]);
+        glm::vec3 y = glm::vec3(matrix[1]);
+        glm::vec3 z = glm::vec3(matrix[2]);
+        glm::vec3 yz = glm::cross(y, z);
+        glm::vec3 zx = glm::cross(z, x);
+        glm::vec3 xy = glm::cross(x, y);
+        float determinant = glm::dot(x, yz);
+        // Degenerate scales keep the unnormalized cofactors, the shaders normalize the result anyway
+        float inverseDeterminant = determinant != 0.0f ? 1.0f / determinant : 1.0f;
+        return glm::mat3(yz * inverseDeterminant, zx * inverseDeterminant, xy * inverseDeterminant);
+    }
+
+    // Recomputes the world matrices of the dirty nodes and their descendants
+    void Update(JobSystem& jobSystem)
+    {
+        PROFILE_FUNCTION();
+        _changedNodes.clear();
+        if (_orderChanged)
+            Reorder();
+        if (!_anyDirty && !_anyChanged)
+            return;
+
+        bool parentLevelChanged = false;
+        for (int level = 0; level + 1 < (int)_levelStarts.size(); level++)
+        {
+            int begin = _levelStarts[level];
+            int end = _levelStarts[level + 1];
+            if (!_dirtyLevels[level] && !parentLevelChanged)
+                continue;
+
+            jobSystem.ParallelFor(end - begin, UPDATE_PARTITION_SIZE, [this, begin](int first, int last) {
+                for (int index = begin + first; index < begin + last; index++)
+                    UpdateNode(index);
+            });
+            _dirtyLevels[level] = 0;
+            parentLevelChanged = true;
+        }
+
+        // Also reports the nodes resolved early by GetWorldMatrix
+        for (int index = 0; index < (int)_changed.size(); index++)
+        {
+            if (_changed[index])
+            {
+                _changed[index] = 0;
+                _changedNodes.push_back(_nodeOfIndex[index]);
+            }
+        }
+        _anyDirty = false;
+        _anyChanged = false;
+    }
+
+    // Nodes whose world matrix changed during the last Update
+    const std::vector<int>& GetChangedNodes() const { return _changedNodes; }
+
+    int GetNodeCount() const { return (int)_nodeOfIndex.size() - (int)_freeNodes.size(); }
+
+private:
+    void MarkDirty(int index)
+    {
+        _dirty[index] = 1;
+        _anyDirty = true;
+        if (_depths[index] < (int)_dirtyLevels.size())
+            _dirtyLevels[_depths[index]] = 1;
+    }
+
+    // Dirty itself, or its parent was recomputed after it
+    bool IsStale(int index) const
+    {
+        int parent = _parents[index];
+        return _dirty[index] || (parent != NONE && _parentVersions[index] != _versions[parent]);
+    }
+
+    void UpdateNode(int index)
+    {
+        if (IsStale(index))
+            Recalculate(index);
+    }
+
+    void Recalculate(int index)
+    {
+        int parent = _parents[index];
+        if (parent != NONE)
+        {
+            _worldMatrices[index] = _worldMatrices[parent] * GetLocalMatrix(index);
+            _parentVersions[index] = _versions[parent];
+        }
+        else
+        {
+            _worldMatrices[index] = _parentMatrices[index] * GetLocalMatrix(index);
+        }
+        _normalMatrices[index] = CalculateNormalMatrix(_worldMatrices[index]);
+        _versions[index]++;
+        _dirty[index] = 0;
+        _changed[index] = 1;
+    }
+
+    // Translation * rotation * scale without building the three matrices
+    glm::mat4 GetLocalMatrix(int index) const
+    {
+        glm::mat3 rotation = glm::mat3_cast(_rotations[index]);
+        const glm::vec3& scale = _scales[index];
+        return glm::mat4(glm::vec4(rotation[0] * scale.x, 0.0f),
+                         glm::vec4(rotation[1] * scale.y, 0.0f),
+                         glm::vec4(rotation[2] * scale.z, 0.0f),
+                         glm::vec4(_positions[index], 1.0f));
+    }
+
+    // Updates the path from the highest stale ancestor down to the node, the rest waits for Update
+    void Resolve(int index)
+    {
+        _resolvePath.clear();
+        int highestStale = NONE;
+        for (int current = index; current != NONE; current = _parents[current])
+        {
+            _resolvePath.push_back(current);
+            if (IsStale(current))
+                highestStale = (int)_resolvePath.size();
+        }
+        if (highestStale == NONE)
+            return;
+
+        _resolvePath.resize(highestStale);
+        for (auto it = _resolvePath.rbegin(); it != _resolvePath.rend(); ++it)
+            Recalculate(*it);
+        // The descendants of the resolved nodes still have to follow
+        _anyChanged = true;
+        for (int current : _resolvePath)
+        {
+            if (_depths[current] < (int)_dirtyLevels.size())
+                _dirtyLevels[_depths[current]] = 1;
+        }
+    }
+
+    // Drops the destroyed nodes and sorts the rest by depth, stable so siblings keep their relative order.
+    // Works in buffers kept between calls, so creating and destroying nodes at a steady rate does not allocate.
+    void Reorder()
+    {
+        PROFILE_FUNCTION();
+        int count = (int)_nodeOfIndex.size();
+        // Children of destroyed nodes become roots
+        for (int index = 0; index < count; index++)
+        {
+            int parent = _parents[index];
+            if (_nodeOfIndex[index] != NONE && parent != NONE && _nodeOfIndex[parent] == NONE)
+            {
+                _parents[index] = NONE;
+                _dirty[index] = 1;
+                _anyDirty = true;
+            }
+        }
+
+        std::vector<int>& depths = _reorderDepths;
+        depths.assign(count, NONE);
+        int maxDepth = 0;
+        for (int index = 0; index < count; index++)
+        {
+            if (_nodeOfIndex[index] == NONE)
+                continue;
+            maxDepth = std::max(maxDepth, CalculateDepth(index, depths));
+        }
+
+        std::vector<int>& levelCounts = _levelCounts;
+        levelCounts.assign(maxDepth + 2, 0);
+        for (int index = 0; index < count; index++)
+        {
+            if (_nodeOfIndex[index] != NONE)
+                levelCounts[depths[index] + 1]++;
+        }
+        for (int level = 1; level < (int)levelCounts.size(); level++)
+            levelCounts[level] += levelCounts[level - 1];
+        _levelStarts = levelCounts;
+
+        // Counting sort by depth
+        std::vector<int>& newIndices = _newIndices;
+        std::vector<int>& order = _order;
+        newIndices.assign(count, NONE);
+        order.resize(levelCounts.back());
+        for (int index = 0; index < count; index++)
+        {
+            if (_nodeOfIndex[index] == NONE)
+                continue;
+            int newIndex = levelCounts[depths[index]]++;
+            newIndices[index] = newIndex;
+            order[newIndex] = index;
+        }
+
+        Permute(_positions, order, _vec3Scratch);
+        Permute(_rotations, order, _quatScratch);
+        Permute(_scales, order, _vec3Scratch);
+        Permute(_parentMatrices, order, _mat4Scratch);
+        Permute(_worldMatrices, order, _mat4Scratch);
+        Permute(_normalMatrices, order, _mat3Scratch);
+        Permute(_dirty, order, _byteScratch);
+        Permute(_changed, order, _byteScratch);
+        Permute(_versions, order, _uintScratch);
+        Permute(_parentVersions, order, _uintScratch);
+        Permute(_nodeOfIndex, order, _intScratch);
+        Permute(_parents, order, _intScratch);
+        for (int& parent : _parents)
+        {
+            if (parent != NONE)
+                parent = newIndices[parent];
+        }
+        _depths.resize(order.size());
+        for (int newIndex = 0; newIndex < (int)order.size(); newIndex++)
+            _depths[newIndex] = depths[order[newIndex]];
+        for (int newIndex = 0; newIndex < (int)order.size(); newIndex++)
+            _indexOfNode[_nodeOfIndex[newIndex]] = newIndex;
+
+        // Restructured subtrees are recomputed as a whole, marking every level is cheaper than finding them
+        _dirtyLevels.assign(_levelStarts.size() - 1, 1);
+        _orderChanged = false;
+    }
+
+    // Walks up to the first ancestor with a known depth, iterative so deep chains do not overflow the stack
+    int CalculateDepth(int index, std::vector<int>& depths)
+    {
+        _resolvePath.clear();
+        int current = index;
+        while (current != NONE && depths[current] == NONE)
+        {
+            _resolvePath.push_back(current);
+            current = _parents[current];
+        }
+        int depth = current == NONE ? -1 : depths[current];
+        for (auto it = _resolvePath.rbegin(); it != _resolvePath.rend(); ++it)
+            depths[*it] = ++depth;
+        return depths[index];
+    }
+
+    // The scratch buffer swaps places with the values, both keep their capacity for the next reorder
+    template<typename T>
+    static void Permute(std::vector<T>& values, const std::vector<int>& order, std::vector<T>& scratch)
+    {
+        scratch.resize(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+            scratch[i] = values[order[i]];
+        values.swap(scratch);
+    }
+
+    static constexpr int UPDATE_PARTITION_SIZE = 1024;
+
+    // Per node, in depth order
+    std::vector<glm::vec3> _positions;
+    std::vector<glm::quat> _rotations;
+    std::vector<glm::vec3> _scales;
+    std::vector<glm::mat4> _parentMatrices;
+    std::vector<glm::mat4> _worldMatrices;
+    std::vector<glm::mat3> _normalMatrices;
+    std::vector<int> _parents;          // Index of the parent, NONE for roots
+    std::vector<int> _depths;
+    std::vector<uint8_t> _dirty;        // Local transform changed since the last update
+    std::vector<uint8_t> _changed;      // World matrix recomputed since the last update
+    std::vector<uint32_t> _versions;        // Incremented whenever the world matrix is recomputed
+    std::vector<uint32_t> _parentVersions;  // Version of the parent the world matrix was computed from
+
+    // First index of every level, the last entry is the node count
+    std::vector<int> _levelStarts;
+    std::vector<uint8_t> _dirtyLevels;
+
+    std::vector<int> _indexOfNode;
+    std::vector<int> _nodeOfIndex;      // NONE for destroyed nodes until the next reorder
+    std::vector<int> _freeNodes;
+
+    std::vector<int> _changedNodes;
+    std::vector<int> _resolvePath;
+
+    // Reorder buffers
+    std::vector<int> _reorderDepths;
+    std::vector<int> _levelCounts;
+    std::vector<int> _newIndices;
+    std::vector<int> _order;
+    std::vector<glm::vec3> _vec3Scratch;
+    std::vector<glm::quat> _quatScratch;
+    std::vector<glm::mat4> _mat4Scratch;
+    std::vector<glm::mat3> _mat3Scratch;
+    std::vector<uint8_t> _byteScratch;
+    std::vector<uint32_t> _uintScratch;
+    std::vector<int> _intScratch;
+    bool _anyDirty = false;
+    bool _anyChanged = false;
+    bool _orderChanged = false;
+};
+
+#endif //OPENGL_GAMEENGINE_TRANSFORMHIERARCHY_HPP
@@ -34,6 +34,7 @@ public:
     void processKeyboard(CameraMovement direction, float deltaTime);
     void processMouseMovement(float xOffset, float yOffset);
     void processMouseScroll(float yOffset);
+    void lookAt(glm::vec3 target);
 
     glm::mat4 getViewMatrix() { return glm::lookAt(position, position + _front, _up); }
     glm::vec3 getFront() { return _front; }
@@ -107,6 +108,15 @@ void Camera::processMouseMovement(float xOffset, float yOffset)
     _updateCameraVectors();
 }
 
+void Camera::lookAt(glm::vec3 target)
+{
+    glm::vec3 direction = glm::normalize(target - position);
+    _yaw = glm::degrees(atan2(direction.z, direction.x));
+    _pitch = glm::clamp(glm::degrees(asin(direction.y)), -89.0f, 89.0f);
+
+    _updateCameraVectors();
+}
+
 void Camera::processMouseScroll(float yOffset)
 {
     fov -= (float)yOffset;
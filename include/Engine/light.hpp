@@ -4,6 +4,9 @@
 #include <glm/glm.hpp>
 #include "Engine/shader.hpp"
 #include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 #include <iostream>
 
 enum LIGHT_TYPE
@@ -23,8 +26,14 @@ public:
     glm::vec3 getAmbient() { return _ambient; }
     glm::vec3 getDiffuse() { return _diffuse; }
     glm::vec3 getSpecular() { return _specular; }
+    // Brightest color component, used to size the light's range
+    float getMaxIntensity()
+    {
+        glm::vec3 maxColor = glm::max(_ambient, glm::max(_diffuse, _specular));
+        return std::max(maxColor.x, std::max(maxColor.y, maxColor.z));
+    }
 
-    virtual void setLightInShader(std::string uniformLightName, Shader& shader) = 0;
+    virtual void setLightInShader(const char* uniformLightName, Shader& shader) = 0;
 protected:
     glm::vec3 _ambient;
     glm::vec3 _diffuse;
@@ -47,14 +56,15 @@ public:
 
     void setDirection(glm::vec3 direction) { _direction = direction; }
 
-    void setLightInShader(std::string uniformLightName, Shader& shader) final
+    void setLightInShader(const char* uniformLightName, Shader& shader) final
     {
+        UniformName name(uniformLightName);
         shader.bind();
-        shader.setUniformFloat3((uniformLightName + ".direction").c_str(), _direction);
+        shader.setUniformFloat3(name.member("direction"), _direction);
 
-        shader.setUniformFloat3((uniformLightName + ".ambient").c_str(), _ambient);
-        shader.setUniformFloat3((uniformLightName + ".diffuse").c_str(), _diffuse);
-        shader.setUniformFloat3((uniformLightName + ".specular").c_str(), _specular);
+        shader.setUniformFloat3(name.member("ambient"), _ambient);
+        shader.setUniformFloat3(name.member("diffuse"), _diffuse);
+        shader.setUniformFloat3(name.member("specular"), _specular);
         shader.unbind();
     }
 private:
@@ -66,6 +76,18 @@ struct Attenuation
     float constant;
     float linear;
     float quadratic;
+
+    // Distance where a light of the given intensity is attenuated below the cutoff
+    float getRange(float intensity, float cutoff = 1.0f / 256.0f) const
+    {
+        // Solves constant + linear * d + quadratic * d^2 = intensity / cutoff
+        float target = intensity / cutoff;
+        if (target <= constant)
+            return 0.0f;
+        if (quadratic <= 0.0f)
+            return linear > 0.0f ? (target - constant) / linear : std::numeric_limits<float>::max();
+        return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * (constant - target))) / (2.0f * quadratic);
+    }
 };
 
 const Attenuation CONST_ATTENUATION{1.0f, 0.09f, 0.032f};
@@ -88,24 +110,26 @@ public:
     float getConstAttenuation() { return _attenuation.constant; }
     float getLinAttenuation() { return _attenuation.linear; }
     float getQuadAttenuation() { return _attenuation.quadratic; }
+    float getRange() { return _attenuation.getRange(getMaxIntensity()); }
 
     void setPosition(glm::vec3 position) { _position = position; }
     void setConstAttenuation(float constAttenuation) { _attenuation.constant = constAttenuation; }
     void setLinAttenuation(float linAttenuation) { _attenuation.linear = linAttenuation; }
     void setQuadAttenuation(float quadAttenuation) { _attenuation.quadratic = quadAttenuation; }
 
-    void setLightInShader(std::string uniformLightName, Shader& shader) final
+    void setLightInShader(const char* uniformLightName, Shader& shader) final
     {
+        UniformName name(uniformLightName);
         shader.bind();
-        shader.setUniformFloat3((uniformLightName + ".position").c_str(), _position);
+        shader.setUniformFloat3(name.member("position"), _position);
 
-        shader.setUniformFloat((uniformLightName + ".constant").c_str(), _attenuation.constant);
-        shader.setUniformFloat((uniformLightName + ".linear").c_str(), _attenuation.linear);
-        shader.setUniformFloat((uniformLightName + ".quadratic").c_str(), _attenuation.quadratic);
+        shader.setUniformFloat(name.member("constant"), _attenuation.constant);
+        shader.setUniformFloat(name.member("linear"), _attenuation.linear);
+        shader.setUniformFloat(name.member("quadratic"), _attenuation.quadratic);
 
-        shader.setUniformFloat3((uniformLightName + ".ambient").c_str(), _ambient);
-        shader.setUniformFloat3((uniformLightName + ".diffuse").c_str(), _diffuse);
-        shader.setUniformFloat3((uniformLightName + ".specular").c_str(), _specular);
+        shader.setUniformFloat3(name.member("ambient"), _ambient);
+        shader.setUniformFloat3(name.member("diffuse"), _diffuse);
+        shader.setUniformFloat3(name.member("specular"), _specular);
         shader.unbind();
     }
 private:
@@ -136,6 +160,7 @@ public:
     float getConstAttenuation() { return _attenuation.constant; }
     float getLinAttenuation() { return _attenuation.linear; }
     float getQuadAttenuation() { return _attenuation.quadratic; }
+    float getRange() { return _attenuation.getRange(getMaxIntensity()); }
 
     void setPosition(glm::vec3 position) { _position = position; }
     void setDirection(glm::vec3 direction) { _direction = direction; }
@@ -145,22 +170,23 @@ public:
     void setLinAttenuation(float linAttenuation) { _attenuation.linear = linAttenuation; }
     void setQuadAttenuation(float quadAttenuation) { _attenuation.quadratic = quadAttenuation; }
 
-    void setLightInShader(std::string uniformLightName, Shader& shader) final
+    void setLightInShader(const char* uniformLightName, Shader& shader) final
     {
+        UniformName name(uniformLightName);
         shader.bind();
-        shader.setUniformFloat3((uniformLightName + ".position").c_str(), _position);
-        shader.setUniformFloat3((uniformLightName + ".direction").c_str(), _direction);
+        shader.setUniformFloat3(name.member("position"), _position);
+        shader.setUniformFloat3(name.member("direction"), _direction);
 
-        shader.setUniformFloat((uniformLightName + ".innerCutOff").c_str(), _innerCutOff);
-        shader.setUniformFloat((uniformLightName + ".outerCutOff").c_str(), _outerCutOff);
+        shader.setUniformFloat(name.member("innerCutOff"), _innerCutOff);
+        shader.setUniformFloat(name.member("outerCutOff"), _outerCutOff);
 
-        shader.setUniformFloat((uniformLightName + ".constant").c_str(), _attenuation.constant);
-        shader.setUniformFloat((uniformLightName + ".linear").c_str(), _attenuation.linear);
-        shader.setUniformFloat((uniformLightName + ".quadratic").c_str(), _attenuation.quadratic);
+        shader.setUniformFloat(name.member("constant"), _attenuation.constant);
+        shader.setUniformFloat(name.member("linear"), _attenuation.linear);
+        shader.setUniformFloat(name.member("quadratic"), _attenuation.quadratic);
 
-        shader.setUniformFloat3((uniformLightName + ".ambient").c_str(), _ambient);
-        shader.setUniformFloat3((uniformLightName + ".diffuse").c_str(), _diffuse);
-        shader.setUniformFloat3((uniformLightName + ".specular").c_str(), _specular);
+        shader.setUniformFloat3(name.member("ambient"), _ambient);
+        shader.setUniformFloat3(name.member("diffuse"), _diffuse);
+        shader.setUniformFloat3(name.member("specular"), _specular);
         shader.unbind();
     }
 private:
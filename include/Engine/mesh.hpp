@@ -3,12 +3,14 @@
 
 #include <glad/glad.h>
 #include <vector>
+#include <cstdio>
 
 #include "Engine/shader.hpp"
 #include "Engine/texture.hpp"
 #include "Engine/VAO.hpp"
 #include "Engine/VBO.hpp"
 #include "Engine/EBO.hpp"
+#include "Engine/Bounds.hpp"
 
 class Mesh
 {
@@ -16,15 +18,24 @@ public:
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
+    float shininess = 32.0f;    // Specular exponent of the mesh's material
 
     Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
     Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures);
 
     void draw(Shader& shader);
+    // Binds the material and vertex array for drawElements, the shader has to be bound
+    void bind(Shader& shader);
+    // Binds only the vertex array, for passes that read no textures
+    void bindVertices();
+    void drawElements();
+    const AABB& getBounds() const { return _bounds; }
 private:
     VAO _VAO;
+    AABB _bounds;
 
     void _createBufferObjects();
+    void _calculateBounds();
 };
 
 Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
@@ -33,6 +44,7 @@ Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
     this->indices = indices;
     textures = std::vector<Texture>();
     _createBufferObjects();
+    _calculateBounds();
 }
 
 Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Texture>& textures)
@@ -41,6 +53,7 @@ Mesh::Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, st
     this->indices = indices;
     this->textures = textures;
     _createBufferObjects();
+    _calculateBounds();
 }
 
 void Mesh::_createBufferObjects()
@@ -64,39 +77,53 @@ void Mesh::_createBufferObjects()
     _EBO.unbind();
 }
 
+void Mesh::_calculateBounds()
+{
+    for (auto& vertex : vertices)
+        _bounds.Extend(vertex.position);
+}
+
 void Mesh::draw(Shader& shader)
 {
     // Use Shader Program
     shader.bind();
+    bind(shader);
+    drawElements();
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+    shader.unbind();
+}
+
+void Mesh::bind(Shader& shader)
+{
     // Activate Texture Units
     unsigned int diffuseCount = 1;
     unsigned int specularCount = 1;
     for (unsigned int i = 0; i < textures.size(); i++)
     {
         glActiveTexture(GL_TEXTURE0 + i);
-        std::string name;
-        std::string number;
+        char name[64] = "";
         TextureType actualType = textures[i].getType();
         if (actualType == TextureType::DIFFUSE)
-        {
-            name = "texture_diffuse";
-            number = std::to_string(diffuseCount++);
-        }
+            std::snprintf(name, sizeof(name), "u_material.texture_diffuse%u", diffuseCount++);
         else if (actualType == TextureType::SPECULAR)
-        {
-            name = "texture_specular";
-            number = std::to_string(specularCount++);
-        }
-        shader.setUniformInt(("u_material." + name + number).c_str(), i);
+            std::snprintf(name, sizeof(name), "u_material.texture_specular%u", specularCount++);
+        shader.setUniformInt(name, i);
         glBindTexture(GL_TEXTURE_2D, textures[i].getID());
     }
-    // Draw
+    shader.setUniformFloat("u_material.shininess", shininess);
     _VAO.bind();
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    shader.unbind();
+void Mesh::bindVertices()
+{
+    _VAO.bind();
+}
+
+void Mesh::drawElements()
+{
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
 }
 
 #endif
\ No newline at end of file
@@ -2,24 +2,58 @@
 #define MODEL_HPP
 
 #include <vector>
+#include <memory>
 
 #include "Engine/shader.hpp"
 #include "Engine/mesh.hpp"
+#include "Engine/OccluderMesh.hpp"
+#include "Engine/CommandList.hpp"
 
 class Model
 {
 public:
-    virtual void draw(Shader& shader, glm::mat4 model);
+    // The normal matrix is the inverse transpose of the model matrix, see Transform::GetNormalMatrix
+    virtual void draw(Shader& shader, const glm::mat4& model, const glm::mat3& normalMatrix);
+    // Adds a draw of every mesh, thread safe as long as the model is not changed meanwhile
+    void recordDraws(const glm::mat4& model, const glm::mat3& normalMatrix, CommandList& commands);
+    const AABB& getBounds();
+    // Simplifies the meshes into an occluder, only models that hide large parts of the scene should have one
+    void buildOccluder(int gridResolution = 8);
+    const OccluderMesh* getOccluder() const { return _occluder.get(); };
 protected:
     std::vector<Mesh> _meshes;
+    AABB _bounds;
+    bool _boundsCalculated = false;
+    std::unique_ptr<OccluderMesh> _occluder;
 };
 
-void Model::draw(Shader& shader, glm::mat4 model)
+const AABB& Model::getBounds()
+{
+    if (!_boundsCalculated)
+    {
+        for (auto& mesh : _meshes)
+            _bounds.Extend(mesh.getBounds());
+        _boundsCalculated = true;
+    }
+    return _bounds;
+}
+
+void Model::buildOccluder(int gridResolution)
+{
+    _occluder = std::make_unique<OccluderMesh>(OccluderMesh::Simplify(_meshes, getBounds(), gridResolution));
+}
+
+void Model::recordDraws(const glm::mat4& model, const glm::mat3& normalMatrix, CommandList& commands)
+{
+    for (auto& mesh : _meshes)
+        commands.Add(&mesh, model, normalMatrix);
+}
+
+void Model::draw(Shader& shader, const glm::mat4& model, const glm::mat3& normalMatrix)
 {
     shader.bind();
-    glm::mat4 modelIT = glm::transpose(glm::inverse(model));
     shader.setUniformMat4("u_model", model);
-    shader.setUniformMat4("u_modelIT", modelIT);
+    shader.setUniformMat3("u_normalMatrix", normalMatrix);
     shader.unbind();
     for (auto & _mesh : _meshes)
         _mesh.draw(shader);
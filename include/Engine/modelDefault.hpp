@@ -3,7 +3,7 @@
 
 #include <string>
 #include <vector>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include "glm/glm.hpp"
 
 #include "assimp/Importer.hpp"
@@ -43,7 +43,7 @@ void ModelDefault::_loadModelDefault(const std::string& path)
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
-        std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
+        LOG_ERROR("Model", "Assimp: %s", importer.GetErrorString());
         return;
     }
     _directory = path.substr(0, path.find_last_of('/'));
@@ -112,9 +112,11 @@ Mesh ModelDefault::_processMesh(aiMesh* mesh, const aiScene* scene)
             indices.push_back(face.mIndices[j]);
     }
     // Materials
+    float shininess = 0.0f;
     if (mesh->mMaterialIndex >= 0)
     {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+        material->Get(AI_MATKEY_SHININESS, shininess);
         // Diffuse
         std::vector<Texture> diffuseMaps = _loadMaterialTextures(material, aiTextureType_DIFFUSE, TextureType::DIFFUSE);
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
@@ -123,7 +125,11 @@ Mesh ModelDefault::_processMesh(aiMesh* mesh, const aiScene* scene)
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
     }
 
-    return Mesh(vertices, indices, textures);
+    Mesh result(vertices, indices, textures);
+    // Materials without a specular exponent keep the mesh's default
+    if (shininess > 0.0f)
+        result.shininess = shininess;
+    return result;
 }
 
 std::vector<Texture> ModelDefault::_loadMaterialTextures(aiMaterial* material, aiTextureType type, TextureType typeName)
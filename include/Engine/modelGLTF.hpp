@@ -3,7 +3,7 @@
 
 #include <string>
 #include <vector>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <sstream>
 #include <algorithm>
 #include "glm/glm.hpp"
@@ -77,7 +77,7 @@ std::string ModelGLTF::_readInFile(const std::string& path)
     }
     catch(const std::exception& e)
     {
-        std::cout << "ERROR::MODEL::FILE_NOT_SUCCESSFULLY_READ " << e.what() <<std::endl;
+        LOG_ERROR("Model", "File not successfully read: %s", e.what());
     }
 
     return fileContent;
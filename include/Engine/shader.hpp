@@ -8,25 +8,38 @@
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <iostream>
+#include "Engine/Log.hpp"
+#include <initializer_list>
+#include <cstdio>
+#include <algorithm>
 
 class Shader
 {
 public:
     // Constructor reads and builds the shader
     Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* geometryPath, const char* fragmentPath);
+    // Compute shader program
+    explicit Shader(const char* computePath);
     // Activates the shader
     void bind() const;
     void unbind() const;
+    // Runs a compute shader program, the shader has to be bound
+    void dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
     // Setters for Uniform Values
     void setUniformInt(const char* name, int value);
+    void setUniformUInt(const char* name, unsigned int value);
+    void setUniformUInt2(const char* name, const glm::uvec2& value);
+    void setUniformUInt3(const char* name, const glm::uvec3& value);
     void setUniformIntArray(const char* name, unsigned long count, int* values);
     void setUniformFloat(const char* name, float value);
+    void setUniformFloatArray(const char* name, unsigned long count, const float* values);
     void setUniformFloat2(const char* name, const glm::vec2& value);
     void setUniformFloat3(const char* name, const glm::vec3& value);
     void setUniformFloat4(const char* name, const glm::vec4& value);
     void setUniformMat3(const char* name, const glm::mat3& value);
     void setUniformMat4(const char* name, const glm::mat4& value);
+    void setUniformMat4Array(const char* name, unsigned long count, const glm::mat4* values);
     // Getters
     unsigned int getID() const;
 
@@ -35,93 +48,168 @@ public:
         return this->_ID == other._ID;
     }
 private:
+    void build(const char* vertexPath, const char* geometryPath, const char* fragmentPath);
+    void link(std::initializer_list<unsigned int> shaders);
+    static std::string readFile(const char* path);
+    // The file with every #include "name" line replaced by the named file, relative to the including one
+    static std::string readSource(const std::string& path, int depth = 0);
+    static unsigned int compileShader(unsigned int type, const char* path);
+
     // The ShaderProgram ID
     unsigned int _ID;
 };
 
+// Name of a uniform struct or of one of its members, such as "u_pointLights[2].position". Built on the stack so
+// the lights can set their uniforms every frame without allocating.
+class UniformName
+{
+public:
+    explicit UniformName(const char* structName)
+    {
+        setLength(std::snprintf(_name, sizeof(_name), "%s", structName));
+    }
+
+    UniformName(const char* arrayName, int index)
+    {
+        setLength(std::snprintf(_name, sizeof(_name), "%s[%d]", arrayName, index));
+    }
+
+    // The struct name followed by the member, valid until the next call
+    const char* member(const char* member)
+    {
+        std::snprintf(_name + _length, sizeof(_name) - _length, ".%s", member);
+        return _name;
+    }
+
+    const char* c_str()
+    {
+        _name[_length] = '\0';
+        return _name;
+    }
+
+private:
+    void setLength(int length) { _length = std::min(std::max(length, 0), (int)sizeof(_name) - 1); }
+
+    char _name[128];
+    int _length = 0;
+};
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
-    // Retrieve the vertex/fragment shader source codes from their path
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+    build(vertexPath, nullptr, fragmentPath);
+}
+
+Shader::Shader(const char* vertexPath, const char* geometryPath, const char* fragmentPath)
+{
+    build(vertexPath, geometryPath, fragmentPath);
+}
+
+Shader::Shader(const char* computePath)
+{
+    unsigned int computeShader = compileShader(GL_COMPUTE_SHADER, computePath);
+    link({computeShader});
+}
+
+std::string Shader::readFile(const char* path)
+{
+    std::ifstream shaderFile;
     // Ensure ifstream objects can throw exceptions
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 
     try
     {
-        // Open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        // Read files' content
-        std::stringstream vShaderStream;
-        std::stringstream fShaderStream;
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // Close files
-        vShaderFile.close();
-        fShaderFile.close();
-        // Convert stream to string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-
+        shaderFile.open(path);
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        return shaderStream.str();
     }
     catch(const std::exception& e)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-    }    
-    
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-
-    // Compile shaders
-    unsigned int vertexShader;
-    unsigned int fragmentShader;
-    int success;
-    char infoLogVert[512];
-    char infoLogFrag[512];
-    char infoLogLink[512];
+        LOG_ERROR("Shader", "File not successfully read: %s", path);
+    }
+    return "";
+}
 
-    // Vertex Shader
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vShaderCode, nullptr);
-    glCompileShader(vertexShader);
-    // Check compilation
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+std::string Shader::readSource(const std::string& path, int depth)
+{
+    static constexpr int MAX_INCLUDE_DEPTH = 8;
+    std::istringstream file(readFile(path.c_str()));
+    std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    std::string source;
+    std::string line;
+    while (std::getline(file, line))
     {
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLogVert);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLogVert << std::endl;
+        size_t begin = line.find('"');
+        size_t end = line.rfind('"');
+        if (line.compare(0, 8, "#include") != 0 || begin == std::string::npos || end <= begin)
+        {
+            source += line;
+            source += '\n';
+            continue;
+        }
+        if (depth >= MAX_INCLUDE_DEPTH)
+        {
+            LOG_ERROR("Shader", "Includes nested too deep: %s", path.c_str());
+            continue;
+        }
+        source += readSource(directory + line.substr(begin + 1, end - begin - 1), depth + 1);
     }
+    return source;
+}
+
+unsigned int Shader::compileShader(unsigned int type, const char* path)
+{
+    std::string code = readSource(path);
+    const char* shaderCode = code.c_str();
 
-    // Fragment Shader
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fShaderCode, nullptr);
-    glCompileShader(fragmentShader);
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &shaderCode, nullptr);
+    glCompileShader(shader);
     // Check compilation
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLogFrag);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLogFrag << std::endl;
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        LOG_ERROR("Shader", "Compilation failed: %s\n%s", path, infoLog);
     }
+    return shader;
+}
+
+void Shader::build(const char* vertexPath, const char* geometryPath, const char* fragmentPath)
+{
+    // Compile shaders
+    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexPath);
+    unsigned int geometryShader = geometryPath != nullptr ? compileShader(GL_GEOMETRY_SHADER, geometryPath) : 0;
+    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentPath);
+
+    if (geometryShader != 0)
+        link({vertexShader, geometryShader, fragmentShader});
+    else
+        link({vertexShader, fragmentShader});
+}
 
+void Shader::link(std::initializer_list<unsigned int> shaders)
+{
     // Shader program
     _ID = glCreateProgram();
-    glAttachShader(_ID, vertexShader);
-    glAttachShader(_ID, fragmentShader);
+    for (unsigned int shader : shaders)
+        glAttachShader(_ID, shader);
     glLinkProgram(_ID);
     // Check linking
+    int success;
+    char infoLogLink[512];
+    glGetProgramiv(_ID, GL_LINK_STATUS, &success);
     if (!success)
     {
         glGetProgramInfoLog(_ID, 512, nullptr, infoLogLink);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLogLink << std::endl;
+        LOG_ERROR("Shader", "Program linking failed\n%s", infoLogLink);
     }
     // Delete linked Shader Objects
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    for (unsigned int shader : shaders)
+        glDeleteShader(shader);
 }
 
 void Shader::bind() const
@@ -135,6 +223,11 @@ void Shader::unbind() const
 }
 
 
+void Shader::dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
+{
+    glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
 unsigned int Shader::getID() const
 {
     return _ID;
@@ -144,6 +237,18 @@ void Shader::setUniformInt(const char* name, int value)
 {
     glUniform1i(glGetUniformLocation(_ID, name), value);
 }
+void Shader::setUniformUInt(const char* name, unsigned int value)
+{
+    glUniform1ui(glGetUniformLocation(_ID, name), value);
+}
+void Shader::setUniformUInt2(const char* name, const glm::uvec2& value)
+{
+    glUniform2ui(glGetUniformLocation(_ID, name), value.x, value.y);
+}
+void Shader::setUniformUInt3(const char* name, const glm::uvec3& value)
+{
+    glUniform3ui(glGetUniformLocation(_ID, name), value.x, value.y, value.z);
+}
 void Shader::setUniformIntArray(const char* name, unsigned long count, int* values)
 {
     glUniform1iv(glGetUniformLocation(_ID, name), count, values);
@@ -152,6 +257,10 @@ void Shader::setUniformFloat(const char* name, float value)
 {
     glUniform1f(glGetUniformLocation(_ID, name), value);
 }
+void Shader::setUniformFloatArray(const char* name, unsigned long count, const float* values)
+{
+    glUniform1fv(glGetUniformLocation(_ID, name), count, values);
+}
 void Shader::setUniformFloat2(const char* name, const glm::vec2& value)
 {
     glUniform2f(glGetUniformLocation(_ID, name), value.x, value.y);
@@ -172,5 +281,9 @@ void Shader::setUniformMat4(const char* name, const glm::mat4& value)
 {
     glUniformMatrix4fv(glGetUniformLocation(_ID, name), 1, GL_FALSE, glm::value_ptr(value));
 }
+void Shader::setUniformMat4Array(const char* name, unsigned long count, const glm::mat4* values)
+{
+    glUniformMatrix4fv(glGetUniformLocation(_ID, name), count, GL_FALSE, glm::value_ptr(values[0]));
+}
 
 #endif
\ No newline at end of file
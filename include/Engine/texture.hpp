@@ -3,7 +3,7 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image/stb_image.h"
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <glad/glad.h>
 
 // TODO TextureType??? Enum for diffuse, specular etc
@@ -60,7 +60,7 @@ Texture::Texture(const char* path, TextureType type)
     }
     else
     {
-        std::cout << "Failed to load texture image data:" << stbi_failure_reason() << std::endl;
+        LOG_ERROR("Texture", "Failed to load texture image data: %s", stbi_failure_reason());
     }
     stbi_image_free(data);
 }
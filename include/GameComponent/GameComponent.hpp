@@ -2,13 +2,28 @@
 #define OPENGL_GAMEENGINE_GAMECOMPONENT_HPP
 
 #include "Engine/Transform.hpp"
+#include "Engine/Bounds.hpp"
+#include "Engine/EntityRegistry.hpp"
+
+struct OccluderMesh;
+class CommandList;
 
 class GameComponent{
 public:
-    virtual void Update(Transform transform) {};
-    virtual void Render(Transform transform) {};
-    virtual void RenderWithShader(Transform transform, Shader& shader) {};
-    virtual void RenderLightsOnly(Transform transform, Shader& shader) {};
+    // Moves the per frame data of the component into components of the object's entity, which systems process in bulk.
+    // Components returning false keep relying on the virtual calls below, their objects are updated one by one.
+    virtual bool Attach(EntityRegistry& entities, Entity entity) { return false; };
+
+    virtual void Update(Transform& transform) {};
+    virtual void Render(Transform& transform) {};
+    virtual void RenderWithShader(Transform& transform, Shader& shader) {};
+    virtual void RenderLightsOnly(Transform& transform, Shader& shader) {};
+    // Adds the draws of the component to a command list, called from worker threads
+    virtual void RecordDraws(Transform& transform, CommandList& commands) {};
+    // Local space bounds of whatever the component draws, false if it has none
+    virtual bool GetBounds(AABB& bounds) { return false; };
+    // Local space mesh rasterized into the occlusion buffer, nullptr if the component does not occlude
+    virtual const OccluderMesh* GetOccluder() { return nullptr; };
 
     virtual void Enable() { enabled = true; };
     virtual void Disable() { enabled = false; };
@@ -16,6 +31,9 @@ public:
 
 protected:
     bool enabled;
+    // Set by components that attach
+    EntityRegistry* entities = nullptr;
+    Entity entity;
 };
 
 #endif //OPENGL_GAMEENGINE_GAMECOMPONENT_HPP
@@ -2,9 +2,32 @@
 #define OPENGL_GAMEENGINE_LIGHTRENDERER_HPP
 
 #include "GameComponent.hpp"
+#include "RenderComponents.hpp"
 #include "Engine/light.hpp"
 #include "Renderer/Renderer.h"
 
+// Submits the lights of every entity to the renderer's prepared frame, added to the scene by the light renderers
+class LightSourceSystem
+{
+public:
+    static void SubmitLights(EntityRegistry& entities)
+    {
+        Renderer* renderer = Renderer::GetInstance();
+        entities.Each<DirectionalLightSource>([renderer](Entity, DirectionalLightSource& source) {
+            if (source.enabled)
+                renderer->SubmitDirectionalLight(source.light);
+        });
+        entities.Each<PointLightSource>([renderer](Entity, PointLightSource& source) {
+            if (source.enabled)
+                renderer->SubmitPointLight(source.light);
+        });
+        entities.Each<SpotLightSource>([renderer](Entity, SpotLightSource& source) {
+            renderer->SubmitSpotLight(source.light);
+        });
+    }
+};
+
+// The light renderers keep their light until they are attached, afterwards it lives in the entity's light source
 class DirectionalLightRenderer : public GameComponent{
 public:
     DirectionalLightRenderer(DirectionalLight& light, Shader& shader) : light(light), shader(shader)
@@ -14,33 +37,56 @@ public:
         Renderer::GetInstance()->AddShadowMap(light, 150.0f);
     };
 
-    void Render(Transform transform)
+    bool Attach(EntityRegistry& entities, Entity entity) override
+    {
+        this->entities = &entities;
+        this->entity = entity;
+        entities.Add<DirectionalLightSource>(entity, light, enabled);
+        entities.AddSystem(LightSourceSystem::SubmitLights);
+        return true;
+    }
+
+    void Render(Transform& transform) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_dirLight", shader);
+            GetLight().setLightInShader("u_dirLight", shader);
         }
     }
 
-    void RenderWithShader(Transform transform, Shader& shader)
+    void RenderWithShader(Transform& transform, Shader& shader) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_dirLight", shader);
+            GetLight().setLightInShader("u_dirLight", shader);
         }
     }
 
-    void RenderLightsOnly(Transform transform, Shader& shader)
+    void RenderLightsOnly(Transform& transform, Shader& shader) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_dirLight", shader);
+            GetLight().setLightInShader("u_dirLight", shader);
         }
     }
 
+    void Enable() override
+    {
+        enabled = true;
+        if (entities != nullptr)
+            entities->Get<DirectionalLightSource>(entity).enabled = true;
+    }
+
+    void Disable() override
+    {
+        enabled = false;
+        if (entities != nullptr)
+            entities->Get<DirectionalLightSource>(entity).enabled = false;
+    }
+
     DirectionalLight& GetLight()
     {
-        return light;
+        return entities != nullptr ? entities->Get<DirectionalLightSource>(entity).light : light;
     }
 
 private:
@@ -53,39 +99,63 @@ public:
     PointLightRenderer(PointLight& light, Shader& shader) : light(light), shader(shader)
     {
         shaderIndex = Renderer::GetInstance()->GetPointLightCount();
+        uniformName = "u_pointLights[" + std::to_string(shaderIndex) + "]";
         Renderer::GetInstance()->AddPointLight();
 
         enabled = true;
         Renderer::GetInstance()->AddShader(&this->shader);
     };
 
-    void Render(Transform transform)
+    bool Attach(EntityRegistry& entities, Entity entity) override
+    {
+        this->entities = &entities;
+        this->entity = entity;
+        entities.Add<PointLightSource>(entity, light, enabled);
+        entities.AddSystem(LightSourceSystem::SubmitLights);
+        return true;
+    }
+
+    void Render(Transform& transform) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_pointLights["+ std::to_string(shaderIndex) +"]", shader);
+            GetPointLight().setLightInShader(uniformName.c_str(), shader);
         }
     }
 
-    void RenderWithShader(Transform transform, Shader& shader)
+    void RenderWithShader(Transform& transform, Shader& shader) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_pointLights["+ std::to_string(shaderIndex) +"]", shader);
+            GetPointLight().setLightInShader(uniformName.c_str(), shader);
         }
     }
 
-    void RenderLightsOnly(Transform transform, Shader& shader)
+    void RenderLightsOnly(Transform& transform, Shader& shader) override
     {
         if (enabled)
         {
-            light.setLightInShader("u_pointLights["+ std::to_string(shaderIndex) +"]", shader);
+            GetPointLight().setLightInShader(uniformName.c_str(), shader);
         }
     }
 
+    void Enable() override
+    {
+        enabled = true;
+        if (entities != nullptr)
+            entities->Get<PointLightSource>(entity).enabled = true;
+    }
+
+    void Disable() override
+    {
+        enabled = false;
+        if (entities != nullptr)
+            entities->Get<PointLightSource>(entity).enabled = false;
+    }
+
     PointLight& GetPointLight()
     {
-        return light;
+        return entities != nullptr ? entities->Get<PointLightSource>(entity).light : light;
     }
 
 private:
@@ -93,6 +163,8 @@ private:
     Shader shader;
 
     int shaderIndex;
+    // Built once, the renderer sets the light every frame
+    std::string uniformName;
 };
 
 class SpotLightRenderer : public GameComponent{
@@ -100,48 +172,60 @@ public:
     SpotLightRenderer(SpotLight& light, Shader& shader) : light(light), shader(shader)
     {
         shaderIndex = Renderer::GetInstance()->GetSpotLightCount();
+        uniformName = "u_spotLights[" + std::to_string(shaderIndex) + "]";
         Renderer::GetInstance()->AddSpotLight();
 
         enabled = true;
         Renderer::GetInstance()->AddShader(&this->shader);
     };
 
-    void Render(Transform transform)
+    bool Attach(EntityRegistry& entities, Entity entity) override
+    {
+        this->entities = &entities;
+        this->entity = entity;
+        entities.Add<SpotLightSource>(entity, light);
+        entities.AddSystem(LightSourceSystem::SubmitLights);
+        return true;
+    }
+
+    void Render(Transform& transform) override
     {
-        light.setLightInShader("u_spotLights["+ std::to_string(shaderIndex) +"]", shader);
+        GetSpotLight().setLightInShader(uniformName.c_str(), shader);
     }
 
-    void RenderWithShader(Transform transform, Shader& shader)
+    void RenderWithShader(Transform& transform, Shader& shader) override
     {
-        light.setLightInShader("u_spotLights["+ std::to_string(shaderIndex) +"]", shader);
+        GetSpotLight().setLightInShader(uniformName.c_str(), shader);
     }
 
-    void RenderLightsOnly(Transform transform, Shader& shader)
+    void RenderLightsOnly(Transform& transform, Shader& shader) override
     {
-        light.setLightInShader("u_spotLights["+ std::to_string(shaderIndex) +"]", shader);
+        GetSpotLight().setLightInShader(uniformName.c_str(), shader);
     }
 
     SpotLight& GetSpotLight()
     {
-        return light;
+        return entities != nullptr ? entities->Get<SpotLightSource>(entity).light : light;
     }
 
     void Disable() override
     {
         enabled = false;
-        ambient = light.getAmbient();
-        diffuse = light.getDiffuse();
-        specular = light.getSpecular();
-        light.setAmbient(glm::vec3(0.0f));
-        light.setDiffuse(glm::vec3(0.0f));
-        light.setSpecular(glm::vec3(0.0f));
+        SpotLight& spotLight = GetSpotLight();
+        ambient = spotLight.getAmbient();
+        diffuse = spotLight.getDiffuse();
+        specular = spotLight.getSpecular();
+        spotLight.setAmbient(glm::vec3(0.0f));
+        spotLight.setDiffuse(glm::vec3(0.0f));
+        spotLight.setSpecular(glm::vec3(0.0f));
     }
 
     void Enable() override
     {
-        light.setAmbient(ambient);
-        light.setDiffuse(diffuse);
-        light.setSpecular(specular);
+        SpotLight& spotLight = GetSpotLight();
+        spotLight.setAmbient(ambient);
+        spotLight.setDiffuse(diffuse);
+        spotLight.setSpecular(specular);
     }
 
 private:
@@ -149,6 +233,7 @@ private:
     Shader shader;
 
     int shaderIndex;
+    std::string uniformName;
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
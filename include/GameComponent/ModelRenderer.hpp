@@ -2,9 +2,12 @@
 #define OPENGL_GAMEENGINE_MODELRENDERER_HPP
 
 #include "GameComponent.hpp"
+#include "RenderComponents.hpp"
 #include "Engine/model.hpp"
 #include "Engine/shader.hpp"
 
+// Authors a MeshRenderer on the object's entity. Draw recording, bounds and occlusion read the entity component,
+// only the immediate Render paths still go through the virtual calls.
 class ModelRenderer : public GameComponent{
 public:
     ModelRenderer(Model* model, Shader& shader) : model(model), shader(shader)
@@ -13,29 +16,51 @@ public:
         Renderer::GetInstance()->AddShader(&this->shader);
     };
 
-    void Render(Transform transform) override
+    bool Attach(EntityRegistry& entities, Entity entity) override
+    {
+        this->entities = &entities;
+        this->entity = entity;
+        entities.Add<MeshRenderer>(entity, model, enabled);
+        return true;
+    }
+
+    void Render(Transform& transform) override
     {
         if (enabled)
         {
-            model->draw(shader, transform.GetModelMatrix());
-            shader.bind();
-            shader.setUniformFloat("u_material.shininess", 32.0f);
-            shader.unbind();
+            model->draw(shader, transform.GetModelMatrix(), transform.GetNormalMatrix());
         }
     }
 
-    void RenderWithShader(Transform transform, Shader& shader) override
+    void RenderWithShader(Transform& transform, Shader& shader) override
     {
         if (enabled)
         {
-            model->draw(shader, transform.GetModelMatrix());
-            shader.bind();
-            shader.setUniformFloat("u_material.shininess", 32.0f);
-            shader.unbind();
+            model->draw(shader, transform.GetModelMatrix(), transform.GetNormalMatrix());
         }
     }
 
+    void Enable() override
+    {
+        SetEnabled(true);
+    }
+
+    void Disable() override
+    {
+        SetEnabled(false);
+    }
+
 private:
+    void SetEnabled(bool isEnabled)
+    {
+        enabled = isEnabled;
+        if (entities != nullptr)
+        {
+            if (MeshRenderer* renderer = entities->TryGet<MeshRenderer>(entity))
+                renderer->enabled = isEnabled;
+        }
+    }
+
     Model* model;
     Shader& shader;
 };
@@ -0,0 +1,34 @@
+#ifndef OPENGL_GAMEENGINE_RENDERCOMPONENTS_HPP
+#define OPENGL_GAMEENGINE_RENDERCOMPONENTS_HPP
+
+#include "Engine/model.hpp"
+#include "Engine/light.hpp"
+
+// Entity components of the rendering game components. The game components only author them, the per frame work
+// reads them in bulk, see GameComponent::Attach.
+
+struct MeshRenderer
+{
+    Model* model;
+    bool enabled;
+};
+
+struct DirectionalLightSource
+{
+    DirectionalLight light;
+    bool enabled;
+};
+
+struct PointLightSource
+{
+    PointLight light;
+    bool enabled;
+};
+
+// Disabled spot lights are kept with zeroed colors, see SpotLightRenderer::Disable
+struct SpotLightSource
+{
+    SpotLight light;
+};
+
+#endif //OPENGL_GAMEENGINE_RENDERCOMPONENTS_HPP
@@ -1,118 +1,347 @@
 #ifndef OPENGL_GAMEENGINE_GAMEOBJECT_HPP
 #define OPENGL_GAMEENGINE_GAMEOBJECT_HPP
 
-#include <vector>
-#include <memory>
+#include <array>
 #include "Engine/model.hpp"
 #include "Engine/shader.hpp"
 #include "Engine/Transform.hpp"
+#include "Engine/Bounds.hpp"
+#include "Engine/EntityRegistry.hpp"
+#include "Engine/ObjectPool.hpp"
+#include "Engine/Log.hpp"
 #include "GameComponent/GameComponent.hpp"
+#include "GameComponent/RenderComponents.hpp"
 
+class GameObject;
+
+// Tags the entities of objects with components that did not attach, the scene updates those objects one by one
+struct LegacyComponents
+{
+    GameObject* gameObject;
+};
+
+class TransformObserver{
+public:
+    virtual void OnTransformChanged(GameObject* gameObject) = 0;
+};
+
+// Authoring view of an entity: holds its game components, which move their data into the entity when added.
+// Objects live in the scene's pool, keep a Handle to refer to one that may be destroyed meanwhile.
 class GameObject{
 public:
-    GameObject() = default;
+    static constexpr int MAX_COMPONENTS = 8;
 
-    void AddChild(GameObject* entity)
+    GameObject(TransformHierarchy& hierarchy, EntityRegistry& entities, PoolSet& componentPools)
+        : transform(&hierarchy, hierarchy.Create()), _hierarchy(hierarchy), _entities(entities), _entity(entities.Create()),
+          _componentPools(componentPools)
     {
-        if (entity != nullptr)
-        {
-            entity->SetParent(this);
-            _children.push_back(entity);
-        }
+        _entities.Add<Transform>(_entity, transform);
+    }
+
+    GameObject(const GameObject&) = delete;
+    GameObject& operator=(const GameObject&) = delete;
+
+    void AddChild(GameObject* child)
+    {
+        if (child != nullptr)
+            child->SetParent(this);
     }
 
+    // The object does not own the component, the same component may be added to several objects
     void AddComponent(GameComponent* component)
     {
-        if (component != nullptr)
-            _components.push_back(component);
+        AddComponent(component, NOT_POOLED, 0, 0);
+    }
+
+    // Creates the component in the scene's pool of its type, it is destroyed together with the object
+    template<typename T, typename... Args>
+    T* AddComponent(Args&&... args)
+    {
+        ObjectPool<T>& pool = _componentPools.Get<T>();
+        Handle<T> handle = pool.Create(std::forward<Args>(args)...);
+        T* component = pool.Get(handle);
+        if (!AddComponent(component, PoolSet::GetTypeId<T>(), handle.index, handle.generation))
+        {
+            pool.Destroy(handle);
+            return nullptr;
+        }
+        return component;
     }
 
     void SetParent(GameObject* parent)
     {
+        Unlink();
         _parent = parent;
+        if (parent != nullptr)
+        {
+            _nextSibling = parent->_firstChild;
+            if (_nextSibling != nullptr)
+                _nextSibling->_previousSibling = this;
+            parent->_firstChild = this;
+        }
+        _hierarchy.SetParent(transform.GetNode(), parent != nullptr ? parent->transform.GetNode() : TransformHierarchy::NONE);
     }
 
+    GameObject* GetParent() { return _parent; }
+    // Children are iterated with GetFirstChild and GetNextSibling, newest first
+    GameObject* GetFirstChild() { return _firstChild; }
+    GameObject* GetNextSibling() { return _nextSibling; }
+
     void Update()
     {
-        for (auto component : _components)
+        for (int i = 0; i < _componentCount; i++)
         {
-            component->Update(transform);
+            _components[i].component->Update(transform);
         }
     }
 
     void Render()
     {
-        for (auto component : _components)
+        for (int i = 0; i < _componentCount; i++)
         {
-            component->Render(transform);
+            _components[i].component->Render(transform);
         }
     }
 
     void RenderWithShader(Shader& shader)
     {
-        for (auto component : _components)
+        for (int i = 0; i < _componentCount; i++)
         {
-            component->RenderWithShader(transform, shader);
+            _components[i].component->RenderWithShader(transform, shader);
         }
     }
 
     void RenderLightsOnly(Shader& shader)
     {
-        for (auto component : _components)
+        for (int i = 0; i < _componentCount; i++)
         {
-            component->RenderLightsOnly(transform, shader);
+            _components[i].component->RenderLightsOnly(transform, shader);
         }
     }
 
+    // Only reads the object, several threads may record the same object into different lists
+    void RecordDraws(CommandList& commands)
+    {
+        if (const MeshRenderer* renderer = _entities.TryGet<MeshRenderer>(_entity))
+        {
+            if (renderer->enabled)
+                renderer->model->recordDraws(transform.GetModelMatrix(), transform.GetNormalMatrix(), commands);
+        }
+
+        if (!_hasLegacyComponents)
+            return;
+        for (int i = 0; i < _componentCount; i++)
+        {
+            _components[i].component->RecordDraws(transform, commands);
+        }
+    }
+
+    // The children follow with the next hierarchy update of the scene
     void SetPosition(glm::vec3 newPosition)
     {
         transform.SetPosition(newPosition);
-        UpdateTransform();
     }
 
     void SetRotation(glm::quat newRotation)
     {
         transform.SetRotation(newRotation);
-        UpdateTransform();
     }
 
     void SetScale(glm::vec3 newScale)
     {
         transform.SetScale(newScale);
-        UpdateTransform();
     }
 
-    std::vector<GameObject*> GetChildren()
+    // Places the object relative to an external parent matrix
+    void CalculateModelMatrix(const glm::mat4& parentModelMatrix)
+    {
+        transform.SetParentMatrix(parentModelMatrix);
+    }
+
+    void SetCastShadows(bool castShadows)
+    {
+        _castShadows = castShadows;
+    }
+
+    bool GetCastShadows()
+    {
+        return _castShadows;
+    }
+
+    // Static objects are expected to never move, their shadows are cached
+    void SetStatic(bool isStatic)
+    {
+        _static = isStatic;
+        NotifyTransformChanged();
+    }
+
+    bool IsStatic()
     {
-        return _children;
+        return _static;
+    }
+
+    // Merged local space bounds of all components, false if none of them has bounds
+    bool GetLocalBounds(AABB& bounds)
+    {
+        bool hasBounds = false;
+        if (const MeshRenderer* renderer = _entities.TryGet<MeshRenderer>(_entity))
+        {
+            const AABB& modelBounds = renderer->model->getBounds();
+            if (modelBounds.IsValid())
+            {
+                bounds.Extend(modelBounds);
+                hasBounds = true;
+            }
+        }
+
+        if (!_hasLegacyComponents)
+            return hasBounds;
+        for (int i = 0; i < _componentCount; i++)
+        {
+            AABB componentBounds;
+            if (_components[i].component->GetBounds(componentBounds))
+            {
+                bounds.Extend(componentBounds);
+                hasBounds = true;
+            }
+        }
+        return hasBounds;
+    }
+
+    const AABB& GetWorldBounds() { return _worldBounds; }
+
+    Entity GetEntity() { return _entity; }
+    Handle<GameObject> GetHandle() { return _handle; }
+
+    // The first occluder among the components
+    const OccluderMesh* GetOccluder()
+    {
+        if (const MeshRenderer* renderer = _entities.TryGet<MeshRenderer>(_entity))
+        {
+            if (renderer->enabled)
+            {
+                if (auto occluder = renderer->model->getOccluder())
+                    return occluder;
+            }
+        }
+
+        if (!_hasLegacyComponents)
+            return nullptr;
+        for (int i = 0; i < _componentCount; i++)
+        {
+            if (auto occluder = _components[i].component->GetOccluder())
+                return occluder;
+        }
+        return nullptr;
     }
 
     Transform transform;
 
 protected:
-    void UpdateTransform()
+    friend class Scene;
+
+    static constexpr int NOT_POOLED = -1;
+
+    struct ComponentSlot
     {
-        if (_parent != nullptr)
+        GameComponent* component;
+        int poolType;   // PoolSet type id of owned components, NOT_POOLED otherwise
+        uint32_t poolIndex;
+        uint32_t poolGeneration;
+    };
+
+    bool AddComponent(GameComponent* component, int poolType, uint32_t poolIndex, uint32_t poolGeneration)
+    {
+        if (component == nullptr)
+            return false;
+        if (_componentCount == MAX_COMPONENTS)
         {
-            transform.CalculateModelMatrix(_parent->transform.GetModelMatrix());
+            LOG_ERROR("GameObject", "More than %d components on an object", MAX_COMPONENTS);
+            return false;
         }
-        else
+
+        _components[_componentCount++] = {component, poolType, poolIndex, poolGeneration};
+        if (!component->Attach(_entities, _entity) && !_hasLegacyComponents)
         {
-            transform.CalculateModelMatrix();
+            _hasLegacyComponents = true;
+            _entities.Add<LegacyComponents>(_entity, this);
         }
+        NotifyTransformChanged();
+        return true;
+    }
 
-        for (auto child : _children)
+    // Removes the object from its parent's children
+    void Unlink()
+    {
+        if (_parent == nullptr)
+            return;
+        if (_previousSibling != nullptr)
+            _previousSibling->_nextSibling = _nextSibling;
+        else
+            _parent->_firstChild = _nextSibling;
+        if (_nextSibling != nullptr)
+            _nextSibling->_previousSibling = _previousSibling;
+        _parent = nullptr;
+        _previousSibling = nullptr;
+        _nextSibling = nullptr;
+    }
+
+    // Called by the scene before the object is destroyed, the children become roots
+    void Release()
+    {
+        Unlink();
+        while (_firstChild != nullptr)
+            _firstChild->Unlink();
+
+        for (int i = 0; i < _componentCount; i++)
         {
-            child->UpdateTransform();
+            const ComponentSlot& slot = _components[i];
+            if (slot.poolType != NOT_POOLED)
+                _componentPools.Destroy(slot.poolType, slot.poolIndex, slot.poolGeneration);
         }
+        _componentCount = 0;
     }
 
-    // Unique pointerek
-    // "Fa" szerkezet helyett lehetne lista, ahol minden entity benne van alapbol, es a szulo az "indexel" hivatkozik ra
-    //          - hatuluto: a vector nem jo adatstruktura erre -> 3rd party colony adatstruktura
-    std::vector<GameObject*> _children;
-    std::vector<GameComponent*> _components;
+    void NotifyTransformChanged()
+    {
+        if (_observer != nullptr && _changedIndex == -1)
+            _observer->OnTransformChanged(this);
+    }
+
+    bool CalculateWorldBounds()
+    {
+        AABB localBounds;
+        if (!GetLocalBounds(localBounds))
+            return false;
+
+        _worldBounds = localBounds.Transformed(transform.GetModelMatrix());
+        return true;
+    }
+
+    // Fixed size and intrusive, so creating and destroying objects does not touch the heap
+    std::array<ComponentSlot, MAX_COMPONENTS> _components;
+    int _componentCount = 0;
     GameObject* _parent = nullptr;
+    GameObject* _firstChild = nullptr;
+    GameObject* _nextSibling = nullptr;
+    GameObject* _previousSibling = nullptr;
+    TransformHierarchy& _hierarchy;
+    EntityRegistry& _entities;
+    Entity _entity;
+    PoolSet& _componentPools;
+    Handle<GameObject> _handle;
+    bool _destroyPending = false;
+    bool _hasLegacyComponents = false;
+    bool _castShadows = true;
+    bool _static = false;
+
+    // Spatial index bookkeeping, owned by the Scene
+    TransformObserver* _observer = nullptr;
+    int _changedIndex = -1;       // Position in the scene's changed list, -1 while unchanged since the last update
+    int _unboundedIndex = -1;     // Position in the scene's unbounded list, -1 while the object has bounds
+    bool _wasStatic = false;
+    int _spatialProxy = -1;
+    AABB _worldBounds;
 };
 
 #endif //OPENGL_GAMEENGINE_GAMEOBJECT_HPP
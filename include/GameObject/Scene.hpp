@@ -1,54 +1,420 @@
 #ifndef OPENGL_GAMEENGINE_SCENE_HPP
 #define OPENGL_GAMEENGINE_SCENE_HPP
 
-#include <colony/plf_colony.h>
+#include <algorithm>
+#include "Engine/Bounds.hpp"
+#include "Engine/DynamicBVH.hpp"
+#include "Engine/CommandList.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/TransformHierarchy.hpp"
+#include "Engine/EntityRegistry.hpp"
+#include "Engine/ObjectPool.hpp"
 #include "GameObject.hpp"
 
-class Scene{
+class Scene : public TransformObserver{
 public:
-    Scene() : _gameObjects() {};
+    Scene() = default;
 
+    ~Scene()
+    {
+        // Components owned by the objects go back to their pools first
+        _gameObjects.ForEach([](GameObject& gameObject) {
+            gameObject.Release();
+        });
+    }
+
+    // Only objects with components that did not attach are visited one by one, the rest is done by the systems
     void Update()
     {
-        for (auto gameObject : _gameObjects)
-        {
-            gameObject->Update();
-        }
+        DestroyPendingObjects();
+
+        _entities.Each<LegacyComponents>([](Entity, LegacyComponents& components) {
+            components.gameObject->Update();
+        });
+        _entities.RunSystems();
+
+        UpdateTransforms();
+        UpdateSpatialIndex();
     }
 
     void Render()
     {
-        for (auto gameObject : _gameObjects)
+        _gameObjects.ForEach([](GameObject& gameObject) {
+            gameObject.Render();
+        });
+    }
+
+    void Render(const Frustum& frustum)
+    {
+        for (auto gameObject : _unboundedObjects)
         {
             gameObject->Render();
         }
+
+        _spatialIndex.Query(frustum, [](GameObject* gameObject) {
+            gameObject->Render();
+            return true;
+        });
     }
 
     void RenderWithShader(Shader& shader)
     {
-        for (auto gameObject : _gameObjects)
+        _gameObjects.ForEach([&shader](GameObject& gameObject) {
+            gameObject.RenderWithShader(shader);
+        });
+    }
+
+    void RenderWithShader(Shader& shader, const Frustum& frustum)
+    {
+        for (auto gameObject : _unboundedObjects)
         {
             gameObject->RenderWithShader(shader);
         }
+
+        _spatialIndex.Query(frustum, [&shader](GameObject* gameObject) {
+            gameObject->RenderWithShader(shader);
+            return true;
+        });
     }
 
-    void RenderLightsOnly(Shader& shader)
+    // Renders the unbounded objects and the given list, which is usually the result of a culled QueryFrustum
+    void Render(const std::vector<GameObject*>& visibleObjects)
+    {
+        for (auto gameObject : _unboundedObjects)
+        {
+            gameObject->Render();
+        }
+
+        for (auto gameObject : visibleObjects)
+        {
+            gameObject->Render();
+        }
+    }
+
+    void RenderWithShader(Shader& shader, const std::vector<GameObject*>& visibleObjects)
+    {
+        for (auto gameObject : _unboundedObjects)
+        {
+            gameObject->RenderWithShader(shader);
+        }
+
+        for (auto gameObject : visibleObjects)
+        {
+            gameObject->RenderWithShader(shader);
+        }
+    }
+
+    void RenderShadowCasters(Shader& shader, const std::vector<GameObject*>& shadowCasters, bool staticCasters)
+    {
+        for (auto gameObject : _unboundedObjects)
+        {
+            if (gameObject->GetCastShadows() && gameObject->IsStatic() == staticCasters)
+                gameObject->RenderWithShader(shader);
+        }
+
+        for (auto gameObject : shadowCasters)
+        {
+            gameObject->RenderWithShader(shader);
+        }
+    }
+
+    // Records the draws of the unbounded objects and the given list, which is usually the result of a culled QueryFrustum.
+    // The list is split into partitions recorded on the job system's threads, their commands are merged in order.
+    void RecordDraws(const std::vector<GameObject*>& visibleObjects, CommandList& commands, JobSystem& jobSystem)
     {
-        for (auto gameObject : _gameObjects)
+        commands.Clear();
+        for (auto gameObject : _unboundedObjects)
         {
-            gameObject->RenderLightsOnly(shader);
+            gameObject->RecordDraws(commands);
         }
+        RecordPartitioned(visibleObjects, commands, jobSystem);
     }
 
+    void RecordShadowCasters(const std::vector<GameObject*>& shadowCasters, bool staticCasters, CommandList& commands, JobSystem& jobSystem)
+    {
+        commands.Clear();
+        for (auto gameObject : _unboundedObjects)
+        {
+            if (gameObject->GetCastShadows() && gameObject->IsStatic() == staticCasters)
+                gameObject->RecordDraws(commands);
+        }
+        RecordPartitioned(shadowCasters, commands, jobSystem);
+    }
+
+    void RenderLightsOnly(Shader& shader)
+    {
+        _gameObjects.ForEach([&shader](GameObject& gameObject) {
+            gameObject.RenderLightsOnly(shader);
+        });
+    }
+
+    // The object stays at the same address until it is destroyed
     GameObject* CreateGameObject()
     {
-        auto gameObject = new GameObject();
-        _gameObjects.insert(gameObject);
+        Handle<GameObject> handle = _gameObjects.Create(_transforms, _entities, _componentPools);
+        GameObject* gameObject = _gameObjects.Get(handle);
+        gameObject->_handle = handle;
+        gameObject->_observer = this;
+        int node = gameObject->transform.GetNode();
+        if (node >= (int)_objectsByNode.size())
+            _objectsByNode.resize(node + 1, nullptr);
+        _objectsByNode[node] = gameObject;
+        gameObject->NotifyTransformChanged();
         return gameObject;
     }
 
+    // nullptr once the object was destroyed
+    GameObject* GetGameObject(Handle<GameObject> handle)
+    {
+        return _gameObjects.Get(handle);
+    }
+
+    // The object is destroyed at the start of the next Update, after everything recorded this frame is done with it.
+    // Its children become roots, the components it owns go back to their pools.
+    void DestroyGameObject(GameObject* gameObject)
+    {
+        if (gameObject == nullptr || gameObject->_destroyPending || _gameObjects.Get(gameObject->_handle) != gameObject)
+            return;
+        gameObject->_destroyPending = true;
+        _pendingDestroy.push_back(gameObject->_handle);
+    }
+
+    void DestroyGameObject(Handle<GameObject> handle)
+    {
+        DestroyGameObject(_gameObjects.Get(handle));
+    }
+
+    int GetGameObjectCount() { return _gameObjects.GetCount(); }
+
+    void OnTransformChanged(GameObject* gameObject) override
+    {
+        gameObject->_changedIndex = (int)_changedObjects.size();
+        _changedObjects.push_back(gameObject);
+    }
+
+    /// Spatial queries, only objects with bounds are reported
+    void QueryFrustum(const Frustum& frustum, std::vector<GameObject*>& result)
+    {
+        _spatialIndex.Query(frustum, [&frustum, &result](GameObject* gameObject) {
+            if (frustum.Intersects(gameObject->GetWorldBounds()))
+                result.push_back(gameObject);
+            return true;
+        });
+    }
+
+    void QueryBox(const AABB& box, std::vector<GameObject*>& result)
+    {
+        _spatialIndex.Query(box, [&box, &result](GameObject* gameObject) {
+            if (box.Intersects(gameObject->GetWorldBounds()))
+                result.push_back(gameObject);
+            return true;
+        });
+    }
+
+    void QuerySphere(const Sphere& sphere, std::vector<GameObject*>& result)
+    {
+        _spatialIndex.Query(sphere, [&sphere, &result](GameObject* gameObject) {
+            if (sphere.Intersects(gameObject->GetWorldBounds()))
+                result.push_back(gameObject);
+            return true;
+        });
+    }
+
+    // Static or dynamic casters inside the light volume whose bounds, swept along the light direction, reach the view frustum
+    void QueryShadowCasters(const Frustum& lightFrustum, const Frustum& viewFrustum, glm::vec3 lightDirection,
+                            float shadowDistance, bool staticCasters, std::vector<GameObject*>& result)
+    {
+        glm::vec3 sweep = lightDirection * shadowDistance;
+        _spatialIndex.Query(lightFrustum, [&](GameObject* gameObject) {
+            if (!gameObject->GetCastShadows() || gameObject->IsStatic() != staticCasters)
+                return true;
+
+            const AABB& bounds = gameObject->GetWorldBounds();
+            if (lightFrustum.Intersects(bounds) && viewFrustum.Intersects(bounds.Swept(sweep)))
+                result.push_back(gameObject);
+            return true;
+        });
+    }
+
+    // Changes whenever a static object is added, moved or removed, cached static data compares against it
+    unsigned long GetStaticVersion() { return _staticVersion; }
+
+    // Returns the object whose bounds the ray enters first, or nullptr
+    GameObject* Raycast(const Ray& ray, float maxDistance, float* hitDistance = nullptr)
+    {
+        GameObject* closestObject = nullptr;
+        float closestDistance = maxDistance;
+        _spatialIndex.RayCast(ray, maxDistance, [&](GameObject* gameObject, float) {
+            float distance = ray.Intersect(gameObject->GetWorldBounds(), closestDistance);
+            if (distance >= 0.0f)
+            {
+                closestObject = gameObject;
+                closestDistance = distance;
+            }
+            return closestDistance;
+        });
+
+        if (hitDistance != nullptr && closestObject != nullptr)
+            *hitDistance = closestDistance;
+        return closestObject;
+    }
+
+    TransformHierarchy& GetTransforms() { return _transforms; }
+    // Entities of the game objects, systems added here run every Update
+    EntityRegistry& GetEntities() { return _entities; }
+
 private:
-    plf::colony<GameObject*> _gameObjects;
+    void DestroyPendingObjects()
+    {
+        for (Handle<GameObject> handle : _pendingDestroy)
+        {
+            GameObject* gameObject = _gameObjects.Get(handle);
+            if (gameObject->_spatialProxy != DynamicBVH<GameObject*>::NullNode)
+                _spatialIndex.DestroyProxy(gameObject->_spatialProxy);
+            if (gameObject->_unboundedIndex != NOT_UNBOUNDED)
+                RemoveUnbounded(gameObject);
+            // Only objects changed since the last update are still listed
+            if (gameObject->_changedIndex != NOT_CHANGED)
+                RemoveChanged(gameObject);
+            if (gameObject->_wasStatic)
+                _staticVersion++;
+            _objectsByNode[gameObject->transform.GetNode()] = nullptr;
+            _transforms.Destroy(gameObject->transform.GetNode());
+            _entities.Destroy(gameObject->_entity);
+
+            gameObject->Release();
+            _gameObjects.Destroy(handle);
+        }
+        _pendingDestroy.clear();
+    }
+
+    // Propagates the transforms changed since the last frame down the hierarchy, moved objects get their bounds refitted
+    void UpdateTransforms()
+    {
+        _transforms.Update(JobSystem::GetInstance());
+        for (int node : _transforms.GetChangedNodes())
+        {
+            if (GameObject* gameObject = _objectsByNode[node])
+                gameObject->NotifyTransformChanged();
+        }
+    }
+
+    // Refits the proxies of every object whose transform or components changed since the last frame
+    void UpdateSpatialIndex()
+    {
+        // The world bounds only depend on the object itself, they are calculated on the job system before the serial refit
+        int changedCount = (int)_changedObjects.size();
+        _refitCenters.resize(changedCount);
+        _refitBounded.resize(changedCount);
+        JobSystem::GetInstance().ParallelFor(changedCount, REFIT_PARTITION_SIZE, [this](int begin, int end) {
+            PROFILE_ZONE("World bounds");
+            for (int i = begin; i < end; i++)
+            {
+                _refitCenters[i] = _changedObjects[i]->_worldBounds.GetCenter();
+                _refitBounded[i] = _changedObjects[i]->CalculateWorldBounds();
+            }
+        });
+
+        for (int i = 0; i < changedCount; i++)
+        {
+            GameObject* gameObject = _changedObjects[i];
+            gameObject->_changedIndex = NOT_CHANGED;
+            if (gameObject->_static || gameObject->_wasStatic)
+                _staticVersion++;
+            gameObject->_wasStatic = gameObject->_static;
+            glm::vec3 previousCenter = _refitCenters[i];
+
+            if (!_refitBounded[i])
+            {
+                if (gameObject->_unboundedIndex == NOT_UNBOUNDED)
+                {
+                    gameObject->_unboundedIndex = (int)_unboundedObjects.size();
+                    _unboundedObjects.push_back(gameObject);
+                }
+                continue;
+            }
+
+            if (gameObject->_unboundedIndex != NOT_UNBOUNDED)
+                RemoveUnbounded(gameObject);
+
+            if (gameObject->_spatialProxy == DynamicBVH<GameObject*>::NullNode)
+            {
+                gameObject->_spatialProxy = _spatialIndex.CreateProxy(gameObject->_worldBounds, gameObject);
+            }
+            else
+            {
+                glm::vec3 displacement = gameObject->_worldBounds.GetCenter() - previousCenter;
+                _spatialIndex.MoveProxy(gameObject->_spatialProxy, gameObject->_worldBounds, displacement);
+            }
+        }
+        _changedObjects.clear();
+
+        _spatialIndex.Rebalance(REBALANCE_ITERATIONS);
+    }
+
+    // Swaps the last unbounded object into the gap, their order does not matter
+    void RemoveUnbounded(GameObject* gameObject)
+    {
+        GameObject* last = _unboundedObjects.back();
+        _unboundedObjects[gameObject->_unboundedIndex] = last;
+        last->_unboundedIndex = gameObject->_unboundedIndex;
+        _unboundedObjects.pop_back();
+        gameObject->_unboundedIndex = NOT_UNBOUNDED;
+    }
+
+    // Swaps the last changed object into the gap, the refit does not depend on their order
+    void RemoveChanged(GameObject* gameObject)
+    {
+        GameObject* last = _changedObjects.back();
+        _changedObjects[gameObject->_changedIndex] = last;
+        last->_changedIndex = gameObject->_changedIndex;
+        _changedObjects.pop_back();
+        gameObject->_changedIndex = NOT_CHANGED;
+    }
+
+    void RecordPartitioned(const std::vector<GameObject*>& gameObjects, CommandList& commands, JobSystem& jobSystem)
+    {
+        int partitionCount = ((int)gameObjects.size() + RECORD_PARTITION_SIZE - 1) / RECORD_PARTITION_SIZE;
+        if ((int)_partitionCommands.size() < partitionCount)
+            _partitionCommands.resize(partitionCount);
+
+        jobSystem.ParallelFor((int)gameObjects.size(), RECORD_PARTITION_SIZE, [&](int begin, int end) {
+            PROFILE_ZONE("Record draws");
+            CommandList& partition = _partitionCommands[begin / RECORD_PARTITION_SIZE];
+            partition.Clear();
+            for (int i = begin; i < end; i++)
+            {
+                gameObjects[i]->RecordDraws(partition);
+            }
+        });
+
+        for (int i = 0; i < partitionCount; i++)
+        {
+            commands.Append(_partitionCommands[i]);
+        }
+    }
+
+    static constexpr int NOT_UNBOUNDED = -1;
+    static constexpr int NOT_CHANGED = -1;
+    static constexpr int REBALANCE_ITERATIONS = 4;
+    static constexpr int RECORD_PARTITION_SIZE = 64;
+    static constexpr int REFIT_PARTITION_SIZE = 256;
+
+    // Declared first so the component pools outlive the objects
+    PoolSet _componentPools;
+    ObjectPool<GameObject> _gameObjects;
+    std::vector<Handle<GameObject>> _pendingDestroy;
+    TransformHierarchy _transforms;
+    EntityRegistry _entities;
+    std::vector<GameObject*> _objectsByNode;
+    std::vector<GameObject*> _changedObjects;
+    std::vector<GameObject*> _unboundedObjects;
+    DynamicBVH<GameObject*> _spatialIndex;
+    // Kept between frames so recording does not allocate once the lists have grown
+    std::vector<CommandList> _partitionCommands;
+    std::vector<glm::vec3> _refitCenters;
+    std::vector<char> _refitBounded;
+    unsigned long _staticVersion = 0;
 };
 
 #endif //OPENGL_GAMEENGINE_SCENE_HPP
@@ -0,0 +1,6 @@
+#version 460 core
+
+// Depth only, the color writes are masked during the pre-pass
+void main()
+{
+}
\ No newline at end of file
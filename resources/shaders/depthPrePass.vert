@@ -0,0 +1,14 @@
+#version 460 core
+
+uniform mat4 u_vp;
+uniform mat4 u_model;
+
+layout (location = 0) in vec3 inPos;
+
+// Computed exactly like the shading passes, which test for equal depth after the pre-pass
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = u_vp * u_model * vec4(inPos, 1.0);
+}
\ No newline at end of file
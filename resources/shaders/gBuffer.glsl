@@ -0,0 +1,28 @@
+// G-buffer encoding shared by the geometry pass that writes it and the lighting passes that read it, included by
+// Shader through #include so the encoder and decoders can not drift apart
+
+// Octahedral normal encoding, maps the unit sphere onto [-1, 1]^2
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 signs = vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    return n.z >= 0.0f ? n.xy : (1.0f - abs(n.yx)) * signs;
+}
+
+// Inverse of EncodeNormal
+vec3 DecodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+// World space position from the depth buffer
+vec3 ReconstructPosition(vec2 texCoord, float depth, mat4 inverseVP)
+{
+    vec4 clip = vec4(vec3(texCoord, depth) * 2.0f - 1.0f, 1.0f);
+    vec4 world = inverseVP * clip;
+    return world.xyz / world.w;
+}
@@ -1,8 +1,8 @@
 #version 460 core
+#include "gBuffer.glsl"
 
-layout (location = 0) out vec4 gPosition;
-layout (location = 1) out vec4 gNormal;
-layout (location = 2) out vec4 gAlbedoSpec;
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedoSpec;
 
 in vec3 vertNorm;
 in vec2 vertTexCoord;
@@ -21,8 +21,7 @@ uniform Material u_material;
 
 void main()
 {
-    gPosition = vec4(vertFragPos, 1.0f);
-    gNormal = vec4((normalize(vertNorm)), 1.0f);
+    gNormal = EncodeNormal(normalize(vertNorm));
     gAlbedoSpec.rgb = texture(u_material.texture_diffuse1, vertTexCoord).rgb;
     gAlbedoSpec.a = texture(u_material.texture_diffuse1, vertTexCoord).r;
-}
\ No newline at end of file
+}
@@ -2,7 +2,7 @@
 
 uniform mat4 u_vp;
 uniform mat4 u_model;
-uniform mat4 u_modelIT;
+uniform mat3 u_normalMatrix;
 
 layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec3 inNorm;
@@ -12,9 +12,12 @@ out vec3 vertNorm;
 out vec2 vertTexCoord;
 out vec3 vertFragPos;
 
+// Same position as depthPrePass.vert, the pass after a depth pre-pass tests for equal depth
+invariant gl_Position;
+
 void main()
 {
-    vertNorm = (u_modelIT * vec4(inNorm, 0.0f)).xyz;
+    vertNorm = u_normalMatrix * inNorm;
     vertTexCoord = inTexCoord;
     vertFragPos = (u_model * vec4(inPos, 1.0f)).xyz;
 
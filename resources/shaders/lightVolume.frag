@@ -0,0 +1,134 @@
+#version 460 core
+#include "gBuffer.glsl"
+// Shades the pixels of a single point or spot light, drawn with its light volume and additive blending
+
+struct PointLight
+{
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight
+{
+    vec3 position;
+    vec3 direction;
+    float innerCutOff;
+    float outerCutOff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+#define POINT_LIGHT 0
+#define SPOT_LIGHT 1
+uniform int u_lightType;
+uniform PointLight u_pointLight;
+uniform SpotLight u_spotLight;
+
+uniform vec3 u_viewPos;
+uniform vec2 u_viewportSize;
+
+uniform mat4 u_inverseVP;
+// Part of the G-buffer covered by the scaled render area
+uniform vec2 u_uvScale;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+out vec4 fragCol;
+
+vec3 CalculatePointLight(PointLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
+vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
+
+void main()
+{
+    // Map values
+    vec2 texCoord = gl_FragCoord.xy / u_viewportSize;
+    vec2 gBufferCoord = texCoord * u_uvScale;
+    float depth = texture(gDepth, gBufferCoord).r;
+    if (depth == 1.0f)
+        discard;
+    vec3 deferredFragPos = ReconstructPosition(texCoord, depth, u_inverseVP);
+    vec3 deferredNormal = DecodeNormal(texture(gNormal, gBufferCoord).rg);
+    vec3 diffuseMapValues = (texture(gAlbedoSpec, gBufferCoord)).rgb;
+    float specularMapValue = (texture(gAlbedoSpec, gBufferCoord)).a;
+
+    vec3 norm = normalize(deferredNormal);
+    vec3 viewDir = normalize(u_viewPos - deferredFragPos);
+    vec3 result;
+    if (u_lightType == POINT_LIGHT)
+        result = CalculatePointLight(u_pointLight, deferredFragPos, norm, viewDir, diffuseMapValues, specularMapValue);
+    else
+        result = CalculateSpotLight(u_spotLight, deferredFragPos, norm, viewDir, diffuseMapValues, specularMapValue);
+
+    fragCol = vec4(result, 1.0f);
+}
+
+vec3 CalculatePointLight(PointLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue)
+{
+    // Ambient
+    vec3 ambient = diffuseMapValues * light.ambient;
+    // Diffuse
+    vec3 lightDir = normalize(light.position - position);
+    float diff = clamp(dot(normal, lightDir), 0.0f, 1.0f);
+    vec3 diffuse = (diff * diffuseMapValues) * light.diffuse;
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    vec3 specular = vec3(0.0f);
+    if (diff > 0.0f)
+    {
+        float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
+        specular = (specularMapValue * spec) * light.specular;
+    }
+    // Attenuation
+    float distance = length(light.position - position);
+    float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+    ambient  *= attenuation;
+    diffuse  *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue)
+{
+    // Ambient
+    vec3 ambient = diffuseMapValues * light.ambient;
+    // Diffuse
+    vec3 lightDir = normalize(light.position - position);
+    float diff = clamp(dot(normal, lightDir), 0.0f, 1.0f);
+    vec3 diffuse = (diff * diffuseMapValues) * light.diffuse;
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    vec3 specular = vec3(0.0f);
+    if (diff > 0.0f)
+    {
+        float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
+        specular = (specularMapValue * spec) * light.specular;
+    }
+    // Attenuation
+    float distance = length(light.position - position);
+    float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // Softening
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0f, 1.0f);
+
+    ambient  *= intensity * attenuation;
+    diffuse  *= intensity * attenuation;
+    specular *= intensity * attenuation;
+    return (ambient + diffuse + specular);
+}
\ No newline at end of file
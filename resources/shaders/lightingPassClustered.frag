@@ -0,0 +1,264 @@
+#version 460 core
+#include "gBuffer.glsl"
+
+struct DirectionalLight
+{
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight
+{
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight
+{
+    vec3 position;
+    vec3 direction;
+    float innerCutOff;
+    float outerCutOff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+uniform vec3 u_viewPos;
+#define CASCADE_NUM 4
+uniform mat4 u_lightVP[CASCADE_NUM];
+// View depth where each cascade ends
+uniform float u_cascadeSplits[CASCADE_NUM];
+uniform int u_cascadeCount;
+uniform vec3 u_viewDir;
+
+uniform DirectionalLight u_dirLight;
+
+// Light lists written by clusterCulling.comp
+struct GpuPointLight
+{
+    vec4 positionRange;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;
+};
+
+struct GpuSpotLight
+{
+    vec4 positionRange;
+    vec4 directionCutOff;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;
+};
+
+layout (std430, binding = 0) readonly buffer PointLights { GpuPointLight pointLights[]; };
+layout (std430, binding = 1) readonly buffer SpotLights { GpuSpotLight spotLights[]; };
+layout (std430, binding = 2) readonly buffer LightGrid { uvec4 lightGrid[]; };
+layout (std430, binding = 3) readonly buffer LightIndices { uint lightIndices[]; };
+
+uniform mat4 u_view;
+uniform vec2 u_viewportSize;
+uniform uvec3 u_clusterCount;
+uniform float u_clusterNear;
+uniform float u_clusterFar;
+
+uniform mat4 u_inverseVP;
+// Part of the G-buffer covered by the scaled render area
+uniform vec2 u_uvScale;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+uniform sampler2DArray u_shadowCascades;
+
+in vec2 vertTexCoord;
+
+out vec4 fragCol;
+
+uint GetClusterIndex(vec3 position);
+PointLight UnpackPointLight(GpuPointLight light);
+SpotLight UnpackSpotLight(GpuSpotLight light);
+uint GetClusterIndex(vec3 position)
+{
+    float depth = -(u_view * vec4(position, 1.0)).z;
+    float slice = log(max(depth, u_clusterNear) / u_clusterNear) / log(u_clusterFar / u_clusterNear) * float(u_clusterCount.z);
+    uvec3 cluster = uvec3(uvec2(gl_FragCoord.xy / u_viewportSize * vec2(u_clusterCount.xy)), uint(slice));
+    cluster = min(cluster, u_clusterCount - 1u);
+    return cluster.x + u_clusterCount.x * (cluster.y + u_clusterCount.y * cluster.z);
+}
+
+PointLight UnpackPointLight(GpuPointLight light)
+{
+    return PointLight(light.positionRange.xyz, light.ambient.rgb, light.diffuse.rgb, light.specular.rgb,
+                      light.attenuation.x, light.attenuation.y, light.attenuation.z);
+}
+
+SpotLight UnpackSpotLight(GpuSpotLight light)
+{
+    return SpotLight(light.positionRange.xyz, light.directionCutOff.xyz, light.directionCutOff.w, light.attenuation.w,
+                     light.ambient.rgb, light.diffuse.rgb, light.specular.rgb,
+                     light.attenuation.x, light.attenuation.y, light.attenuation.z);
+}
+
+vec3 CalculateDirLight(DirectionalLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
+vec3 CalculatePointLight(PointLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
+vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
+float CalculateShadow(vec3 position, float NdotL);
+
+void main()
+{
+    // Map values
+    vec2 gBufferCoord = vertTexCoord * u_uvScale;
+    float depth = texture(gDepth, gBufferCoord).r;
+    if (depth == 1.0f)
+    {
+        fragCol = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    vec3 deferredFragPos = ReconstructPosition(vertTexCoord, depth, u_inverseVP);
+    vec3 deferredNormal = DecodeNormal(texture(gNormal, gBufferCoord).rg);
+    vec3 diffuseMapValues = (texture(gAlbedoSpec, gBufferCoord)).rgb;
+    float specularMapValue = (texture(gAlbedoSpec, gBufferCoord)).a;
+
+    // Light calculations
+    vec3 norm = normalize(deferredNormal);
+    vec3 viewDir = normalize(u_viewPos - deferredFragPos);
+    // Directional Lighting
+    vec3 result = CalculateDirLight(u_dirLight, deferredFragPos, norm, viewDir, diffuseMapValues, specularMapValue);
+    // Only the lights of the fragment's cluster
+    uvec4 cluster = lightGrid[GetClusterIndex(deferredFragPos)];
+    // Point Lights
+    for (uint i = 0; i < cluster.y; i++)
+    {
+        PointLight light = UnpackPointLight(pointLights[lightIndices[cluster.x + i]]);
+        result += CalculatePointLight(light, deferredFragPos, norm, viewDir, diffuseMapValues, specularMapValue);
+    }
+    // Spot Lights
+    for (uint i = 0; i < cluster.w; i++)
+    {
+        SpotLight light = UnpackSpotLight(spotLights[lightIndices[cluster.z + i]]);
+        result += CalculateSpotLight(light, deferredFragPos, norm, viewDir, diffuseMapValues, specularMapValue);
+    }
+
+    fragCol = vec4(result, 1.0f);
+}
+
+vec3 CalculateDirLight(DirectionalLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue)
+{
+    // Ambient
+    vec3 ambient = light.ambient;
+    // Diffuse
+    vec3 lightDir = normalize(-light.direction);
+    float NdotL = clamp(dot(normal, lightDir), 0.0f, 1.0f);
+    vec3 diffuse = (NdotL) * light.diffuse;
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    vec3 specular = vec3(0.0f);
+    if (NdotL > 0.0f)
+    {
+        float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
+        specular = spec * light.specular;
+    }
+    float shadow = CalculateShadow(position, NdotL);
+
+    return (ambient + (1.0 - shadow) * (diffuse + specular)) * diffuseMapValues;
+}
+
+vec3 CalculatePointLight(PointLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue)
+{
+    // Ambient
+    vec3 ambient = diffuseMapValues * light.ambient;
+    // Diffuse
+    vec3 lightDir = normalize(light.position - position);
+    float diff = clamp(dot(normal, lightDir), 0.0f, 1.0f);
+    vec3 diffuse = (diff * diffuseMapValues) * light.diffuse;
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    vec3 specular = vec3(0.0f);
+    if (diff > 0.0f)
+    {
+        float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
+        specular = (specularMapValue * spec) * light.specular;
+    }
+    // Attenuation
+    float distance = length(light.position - position);
+    float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+    ambient  *= attenuation;
+    diffuse  *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue)
+{
+    // Ambient
+    vec3 ambient = diffuseMapValues * light.ambient;
+    // Diffuse
+    vec3 lightDir = normalize(light.position - position);
+    float diff = clamp(dot(normal, lightDir), 0.0f, 1.0f);
+    vec3 diffuse = (diff * diffuseMapValues) * light.diffuse;
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    vec3 specular = vec3(0.0f);
+    if (diff > 0.0f)
+    {
+        float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
+        specular = (specularMapValue * spec) * light.specular;
+    }
+    // Attenuation
+    float distance = length(light.position - position);
+    float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // Softening
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0f, 1.0f);
+
+    ambient  *= intensity * attenuation;
+    diffuse  *= intensity * attenuation;
+    specular *= intensity * attenuation;
+    return (ambient + diffuse + specular);
+}
+
+float CalculateShadow(vec3 position, float NdotL)
+{
+    float viewDepth = dot(position - u_viewPos, u_viewDir);
+    for (int i = 0; i < u_cascadeCount; i++)
+    {
+        if (viewDepth > u_cascadeSplits[i])
+            continue;
+
+        vec4 lightSpacePosition = u_lightVP[i] * vec4(position, 1.0);
+        vec3 projCoords = lightSpacePosition.xyz / lightSpacePosition.w;
+        projCoords = projCoords * 0.5 + 0.5;
+        // Cascades updated at a lower rate may lag behind the camera, fall back to the next one
+        if (any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+            continue;
+
+        float lightDepth = texture(u_shadowCascades, vec3(projCoords.xy, float(i))).r;
+        float currentDepth = projCoords.z;
+        //float bias = max(0.001 * (1.0 - NdotL), 0.0001);
+        float bias = 0.0005;
+        return (currentDepth - bias) > lightDepth ? 1.0 : 0.0;
+    }
+
+    return 0.0;
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 460 core
+#include "gBuffer.glsl"
 
 struct DirectionalLight
 {
@@ -39,8 +40,12 @@ struct SpotLight
 };
 
 uniform vec3 u_viewPos;
-#define SHADOW_MAPS_NUM 1
-uniform mat4 u_lightVP[SHADOW_MAPS_NUM];
+#define CASCADE_NUM 4
+uniform mat4 u_lightVP[CASCADE_NUM];
+// View depth where each cascade ends
+uniform float u_cascadeSplits[CASCADE_NUM];
+uniform int u_cascadeCount;
+uniform vec3 u_viewDir;
 
 uniform DirectionalLight u_dirLight;
 #define POINT_LIGHT_NUM 8
@@ -50,10 +55,14 @@ uniform PointLight u_pointLights[POINT_LIGHT_NUM];
 uniform int u_spotLightsNum;
 uniform SpotLight u_spotLights[SPOT_LIGHT_NUM];
 
-uniform sampler2D gPosition;
+uniform mat4 u_inverseVP;
+// Part of the G-buffer covered by the scaled render area
+uniform vec2 u_uvScale;
+
+uniform sampler2D gDepth;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
-uniform sampler2D shadowMaps[SHADOW_MAPS_NUM];
+uniform sampler2DArray u_shadowCascades;
 
 in vec2 vertTexCoord;
 
@@ -62,15 +71,22 @@ out vec4 fragCol;
 vec3 CalculateDirLight(DirectionalLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
 vec3 CalculatePointLight(PointLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
 vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDir, vec3 diffuseMapValues, float specularMapValue);
-float CalculateShadow(vec4 lightSpacePosition, float NdotL);
+float CalculateShadow(vec3 position, float NdotL);
 
 void main()
 {
     // Map values
-    vec3 deferredFragPos = texture(gPosition, vertTexCoord).rgb;
-    vec3 deferredNormal = texture(gNormal, vertTexCoord).rgb;
-    vec3 diffuseMapValues = (texture(gAlbedoSpec, vertTexCoord)).rgb;
-    float specularMapValue = (texture(gAlbedoSpec, vertTexCoord)).a;
+    vec2 gBufferCoord = vertTexCoord * u_uvScale;
+    float depth = texture(gDepth, gBufferCoord).r;
+    if (depth == 1.0f)
+    {
+        fragCol = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    vec3 deferredFragPos = ReconstructPosition(vertTexCoord, depth, u_inverseVP);
+    vec3 deferredNormal = DecodeNormal(texture(gNormal, gBufferCoord).rg);
+    vec3 diffuseMapValues = (texture(gAlbedoSpec, gBufferCoord)).rgb;
+    float specularMapValue = (texture(gAlbedoSpec, gBufferCoord)).a;
 
     // Light calculations
     vec3 norm = normalize(deferredNormal);
@@ -103,7 +119,7 @@ vec3 CalculateDirLight(DirectionalLight light, vec3 position, vec3 normal, vec3
         float spec = pow(clamp(dot(viewDir, reflectDir), 0.0f, 1.0f), 32.0f);
         specular = spec * light.specular;
     }
-    float shadow = CalculateShadow(u_lightVP[0] * vec4(position, 1.0), NdotL);
+    float shadow = CalculateShadow(position, NdotL);
 
     return (ambient + (1.0 - shadow) * (diffuse + specular)) * diffuseMapValues;
 }
@@ -164,19 +180,27 @@ vec3 CalculateSpotLight(SpotLight light, vec3 position, vec3 normal, vec3 viewDi
     return (ambient + diffuse + specular);
 }
 
-float CalculateShadow(vec4 lightSpacePosition, float NdotL)
+float CalculateShadow(vec3 position, float NdotL)
 {
-    vec3 projCoords = lightSpacePosition.xyz / lightSpacePosition.w;
-    projCoords = projCoords * 0.5 + 0.5;
-    float lightDepth = texture(shadowMaps[0], projCoords.xy).r;
-    if (lightDepth == 0.0)
+    float viewDepth = dot(position - u_viewPos, u_viewDir);
+    for (int i = 0; i < u_cascadeCount; i++)
     {
-        return 0.0;
+        if (viewDepth > u_cascadeSplits[i])
+            continue;
+
+        vec4 lightSpacePosition = u_lightVP[i] * vec4(position, 1.0);
+        vec3 projCoords = lightSpacePosition.xyz / lightSpacePosition.w;
+        projCoords = projCoords * 0.5 + 0.5;
+        // Cascades updated at a lower rate may lag behind the camera, fall back to the next one
+        if (any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+            continue;
+
+        float lightDepth = texture(u_shadowCascades, vec3(projCoords.xy, float(i))).r;
+        float currentDepth = projCoords.z;
+        //float bias = max(0.001 * (1.0 - NdotL), 0.0001);
+        float bias = 0.0005;
+        return (currentDepth - bias) > lightDepth ? 1.0 : 0.0;
     }
-    float currentDepth = projCoords.z;
-    //float bias = max(0.001 * (1.0 - NdotL), 0.0001);
-    float bias = 0.0005;
-    float shadow = (currentDepth - bias) > lightDepth ? 1.0 : 0.0;
 
-    return shadow;
+    return 0.0;
 }
\ No newline at end of file
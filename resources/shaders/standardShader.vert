@@ -2,7 +2,7 @@
 
 uniform mat4 u_vp;
 uniform mat4 u_model;
-uniform mat4 u_modelIT;
+uniform mat3 u_normalMatrix;
 
 layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec3 inNorm;
@@ -12,12 +12,15 @@ out vec3 vertNorm;
 out vec2 vertTexCoord;
 out vec3 vertFragPos;
 
+// The forward pass tests against the depth of a pre-pass, see depthPrePass.vert
+invariant gl_Position;
+
 void main()
 {
     //gl_Position = u_mvp * u_model * vec4(inPos, 1.0);
     gl_Position = u_vp * u_model * vec4(inPos, 1.0);
 
-    vertNorm = (u_modelIT * vec4(inNorm, 0.0f)).xyz;
+    vertNorm = u_normalMatrix * inNorm;
     vertTexCoord = inTexCoord;
     vertFragPos = (u_model * vec4(inPos, 1.0f)).xyz;
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#define GLFW_INCLUDE_NONE
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+#include "Engine/shader.hpp"
+#include "Engine/camera.hpp"
+#include "Engine/CameraPath.hpp"
+#include "Engine/Log.hpp"
+#include "Engine/AllocationCounter.hpp"
+#include "Window/Window.h"
+#include "Core/Application.h"
+#include "Core/FrameStatistics.h"
+#include "Benchmark/BenchmarkCommon.h"
+#include "GameObject/Scene.hpp"
+#include "Benchmark/SyntheticScene.h"
+
+// Command line options of a benchmark run
+struct BenchmarkSettings
+{
+    SyntheticSceneSettings scene;
+    int frames = 1000;
+    int warmup = 60;    // Frames rendered before recording, lets drivers compile and caches fill
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    bool dynamicResolution = false;
+    bool renderThread = true;   // Submits on a render thread, --serial prepares and submits on the main thread
+    bool zeroAllocations = false;   // Fails the run when a recorded frame allocates on the heap
+    DepthPrePassMode depthPrePass = DepthPrePassMode::AUTOMATIC;
+    RenderingPath renderingPath = RenderingPath::DEFERRED;
+    std::string outputPath = "benchmark.json";
+};
+
+const char* GetDepthPrePassModeName(DepthPrePassMode mode)
+{
+    return mode == DepthPrePassMode::OFF ? "off" : mode == DepthPrePassMode::ON ? "on" : "auto";
+}
+
+const char* GetRenderingPathName(RenderingPath path)
+{
+    return path == RenderingPath::DEFERRED ? "deferred" : path == RenderingPath::FORWARD ? "forward" : "forward+";
+}
+
+// Renders a synthetic scene for a fixed number of frames along a fixed camera path and reports the frame and phase times
+class BenchmarkApplication : public Application{
+public:
+    BenchmarkApplication(Window& window, const BenchmarkSettings& settings) : Application(window), settings(settings),
+    camera(glm::vec3(0.0f, 0.0f, 3.0f)),
+    shader("./resources/shaders/standardShader.vert", "./resources/shaders/standardShader.frag")
+    {
+    }
+
+    void Setup() override
+    {
+        syntheticScene = std::make_unique<SyntheticScene>(scene, shader, settings.scene);
+        renderer->GetDynamicResolution().SetEnabled(settings.dynamicResolution);
+        renderer->GetDepthPrePass().SetMode(settings.depthPrePass);
+        renderer->SetRenderingPath(settings.renderingPath);
+        SetRenderThreadEnabled(settings.renderThread);
+
+        glm::vec2 viewPortSize = glm::vec2(window.GetWidth(), window.GetHeight());
+        renderer->Init(&camera, &scene, viewPortSize);
+
+        float extent = syntheticScene->GetExtent();
+        cameraPath = CameraPath::Orbit(glm::vec3(0.0f), extent * 1.2f, extent * 0.2f + 5.0f, extent * 0.6f + 10.0f);
+    }
+
+    void PreLoop() override
+    {
+        glm::vec2 viewport = glm::vec2(window.GetWidth(), window.GetHeight());
+        renderer->SetViewportSize(viewport);
+
+        // Fixed 60 Hz steps so every run renders the same frames
+        int recordedFrame = std::max(0, simulatedFrames - settings.warmup);
+        cameraPath.Apply(camera, (float)recordedFrame / settings.frames);
+        syntheticScene->Animate(simulatedFrames++ / 60.0f);
+
+        renderer->PreRender();
+    }
+
+    void OnLoop() override {}
+
+    // Runs after every submitted frame, on the render thread unless the run is serial
+    void PostLoop() override
+    {
+        // Waits for the GPU so the frame time covers the whole frame, nothing is presented to pace it.
+        // With a render thread the main thread overlaps the next frame, so the frame time is the interval between frames.
+        glFinish();
+        auto frameEnd = std::chrono::steady_clock::now();
+        float frameTime = std::chrono::duration<float, std::milli>(frameEnd - lastFrameEnd).count();
+        lastFrameEnd = frameEnd;
+        // Counted up to the bookkeeping of the previous frame, the statistics allocate themselves
+        long allocations = AllocationCounter::GetCount() - bookkeepingAllocations;
+
+        // The first frame has no previous one to measure from
+        if (renderedFrames++ < std::max(1, settings.warmup))
+        {
+            bookkeepingAllocations = AllocationCounter::GetCount();
+            return;
+        }
+
+        const RenderStatistics& renderStatistics = renderer->GetStatistics();
+        statistics.Add("frame", frameTime);
+        statistics.Add("simulation", renderStatistics.simulationTime);
+        statistics.Add("scene update", renderStatistics.sceneUpdateTime);
+        statistics.Add("culling", renderStatistics.cullingTime);
+        statistics.Add("record", renderStatistics.recordTime);
+        statistics.Add("submit", renderStatistics.submitTime);
+        statistics.Add("visible objects", (float)renderStatistics.visibleObjects);
+        statistics.Add("shadow casters", (float)renderStatistics.shadowCasters);
+        statistics.Add("draw commands", (float)renderStatistics.drawCommands);
+        statistics.Add("overdraw", renderStatistics.overdraw);
+        statistics.Add("depth pre-pass", renderStatistics.depthPrePass ? 1.0f : 0.0f);
+        statistics.Add("render passes", (float)renderStatistics.renderPasses);
+        statistics.Add("culled passes", (float)renderStatistics.culledPasses);
+        statistics.Add("render target MB", renderStatistics.renderTargetMemory);
+        statistics.Add("allocations", (float)allocations);
+        if (allocations > 0 && allocatingFrames++ == 0)
+            LOG_WARNING("Benchmark", "Frame %d allocated %ld times on the heap", renderedFrames, allocations);
+
+        GpuProfiler& gpuProfiler = renderer->GetGpuProfiler();
+        if (gpuProfiler.GetResultFrames() != lastGpuResultFrames)
+        {
+            lastGpuResultFrames = gpuProfiler.GetResultFrames();
+            statistics.Add("gpu", gpuProfiler.GetFrameTime());
+            for (int pass = 0; pass < gpuProfiler.GetPassCount(); pass++)
+                statistics.Add("gpu/" + gpuProfiler.GetPassName(pass), gpuProfiler.GetPassTime(pass));
+        }
+
+        if (renderedFrames - std::max(1, settings.warmup) == settings.frames)
+            Finish();
+        bookkeepingAllocations = AllocationCounter::GetCount();
+    }
+
+    // Exit code of the run
+    bool HasFailed() const { return settings.zeroAllocations && allocatingFrames > 0; }
+
+private:
+    void Finish()
+    {
+        FrameStatistics::Summary summary = statistics.Summarize("frame");
+        LOG_INFO("Benchmark", "Frame time over %d frames: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms",
+                 summary.samples, summary.mean, summary.p50, summary.p99, summary.max);
+        FrameStatistics::Summary allocations = statistics.Summarize("allocations");
+        LOG_INFO("Benchmark", "Heap allocations per frame: mean %.1f, max %.0f, %d of %d frames allocated",
+                 allocations.mean, allocations.max, allocatingFrames, allocations.samples);
+        if (HasFailed())
+            LOG_ERROR("Benchmark", "Steady state frames are expected not to allocate");
+
+        nlohmann::json run = {
+                {"frames", settings.frames},
+                {"warmup", settings.warmup},
+                {"width", settings.width},
+                {"height", settings.height},
+                {"dynamicResolution", settings.dynamicResolution},
+                {"renderThread", IsRenderThreadEnabled()},
+                {"zeroAllocations", settings.zeroAllocations},
+                {"depthPrePass", GetDepthPrePassModeName(settings.depthPrePass)},
+                {"renderingPath", GetRenderingPathName(settings.renderingPath)},
+                {"scene", {
+                        {"objects", settings.scene.objects},
+                        {"models", settings.scene.models},
+                        {"pointLights", settings.scene.pointLights},
+                        {"spotLights", settings.scene.spotLights},
+                        {"movingShare", settings.scene.movingShare},
+                        {"movingHierarchies", syntheticScene->GetMovingCount()},
+                        {"hierarchyDepth", settings.scene.hierarchyDepth},
+                        {"seed", settings.scene.seed}
+                }},
+                {"renderer", (const char*)glGetString(GL_RENDERER)},
+                {"version", (const char*)glGetString(GL_VERSION)}
+        };
+        WriteResults("Benchmark", statistics, settings.outputPath, run);
+        glfwSetWindowShouldClose(window.GetGLFWWindow(), true);
+    }
+
+    BenchmarkSettings settings;
+    Camera camera;
+    Shader shader;
+    Scene scene;
+    std::unique_ptr<SyntheticScene> syntheticScene;
+    CameraPath cameraPath;
+
+    FrameStatistics statistics;
+    // The main thread runs ahead of the render thread, so simulated and rendered frames are counted apart
+    int simulatedFrames = 0;
+    int renderedFrames = 0;
+    unsigned int lastGpuResultFrames = 0;
+    std::chrono::steady_clock::time_point lastFrameEnd;
+    long bookkeepingAllocations = 0;
+    int allocatingFrames = 0;
+};
+
+// [--objects n] [--models n] [--point-lights n] [--spot-lights n] [--moving share] [--depth n] [--seed n]
+// [--frames n] [--warmup n] [--width w] [--height h] [--dynamic-resolution] [--serial] [--zero-allocations]
+// [--depth-pre-pass off|on|auto] [--path deferred|forward|forward+] [--output file.json]
+BenchmarkSettings ParseBenchmarkSettings(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    BenchmarkOptions options("Benchmark");
+    options.Add("--objects", settings.scene.objects);
+    options.Add("--models", settings.scene.models, 1);
+    options.Add("--point-lights", settings.scene.pointLights);
+    options.Add("--spot-lights", settings.scene.spotLights);
+    options.Add("--moving", settings.scene.movingShare, 0.0f, 1.0f);
+    options.Add("--depth", settings.scene.hierarchyDepth, 1);
+    options.Add("--seed", settings.scene.seed);
+    options.Add("--frames", settings.frames, 1);
+    options.Add("--warmup", settings.warmup);
+    options.Add("--width", settings.width, 1u);
+    options.Add("--height", settings.height, 1u);
+    options.AddFlag("--dynamic-resolution", settings.dynamicResolution);
+    options.AddFlag("--serial", settings.renderThread, false);
+    options.AddFlag("--zero-allocations", settings.zeroAllocations);
+    options.AddChoice("--depth-pre-pass", settings.depthPrePass, {{"off", DepthPrePassMode::OFF}, {"on", DepthPrePassMode::ON},
+                                                                  {"auto", DepthPrePassMode::AUTOMATIC}});
+    options.AddChoice("--path", settings.renderingPath, {{"deferred", RenderingPath::DEFERRED}, {"forward", RenderingPath::FORWARD},
+                                                         {"forward+", RenderingPath::FORWARD_PLUS}});
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings = ParseBenchmarkSettings(argc, argv);
+    Window window("OpenGL Engine Benchmark", settings.width, settings.height, true);
+    BenchmarkApplication benchmark(window, settings);
+    benchmark.Run();
+    return benchmark.HasFailed() ? 1 : 0;
+}
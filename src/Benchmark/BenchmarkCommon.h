@@ -0,0 +1,155 @@
+#ifndef OPENGL_GAMEENGINE_BENCHMARKCOMMON_H
+#define OPENGL_GAMEENGINE_BENCHMARKCOMMON_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+
+#include "Engine/Log.hpp"
+#include "Core/FrameStatistics.h"
+
+// Command line options of a benchmark executable. Each benchmark declares its options on the fields of its settings
+// struct and parses the command line once, values are clamped to the declared minimum.
+//
+//     BenchmarkOptions options("JobBenchmark");
+//     options.Add("--jobs", settings.jobs, 1);
+//     options.Parse(argc, argv);
+class BenchmarkOptions
+{
+public:
+    explicit BenchmarkOptions(const char* category) : category(category) {}
+
+    void Add(const char* name, int& value, int minimum = 0)
+    {
+        options.push_back({name, true, [&value, minimum](const char* argument) {
+            value = std::max(minimum, std::atoi(argument));
+        }});
+    }
+
+    void Add(const char* name, unsigned int& value, unsigned int minimum = 0)
+    {
+        options.push_back({name, true, [&value, minimum](const char* argument) {
+            value = std::max(minimum, (unsigned int)std::max(0, std::atoi(argument)));
+        }});
+    }
+
+    void Add(const char* name, float& value, float minimum, float maximum)
+    {
+        options.push_back({name, true, [&value, minimum, maximum](const char* argument) {
+            value = std::clamp((float)std::atof(argument), minimum, maximum);
+        }});
+    }
+
+    void Add(const char* name, std::string& value)
+    {
+        options.push_back({name, true, [&value](const char* argument) {
+            value = argument;
+        }});
+    }
+
+    // An option without a value, sets the flag to the given state
+    void AddFlag(const char* name, bool& value, bool state = true)
+    {
+        options.push_back({name, false, [&value, state](const char*) {
+            value = state;
+        }});
+    }
+
+    // An option naming one of the given values
+    template<typename T>
+    void AddChoice(const char* name, T& value, std::initializer_list<std::pair<const char*, T>> choices)
+    {
+        std::vector<std::pair<const char*, T>> names(choices);
+        const char* optionCategory = category;
+        options.push_back({name, true, [&value, names, name, optionCategory](const char* argument) {
+            for (auto& choice : names)
+            {
+                if (std::strcmp(choice.first, argument) == 0)
+                {
+                    value = choice.second;
+                    return;
+                }
+            }
+            LOG_WARNING(optionCategory, "Unknown value of %s: %s", name, argument);
+        }});
+    }
+
+    void Parse(int argc, char** argv) const
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const Option* option = Find(argv[i]);
+            if (option == nullptr || (option->hasValue && i + 1 >= argc))
+            {
+                LOG_WARNING(category, "Unknown argument: %s", argv[i]);
+                continue;
+            }
+            option->set(option->hasValue ? argv[++i] : nullptr);
+        }
+    }
+
+private:
+    struct Option
+    {
+        const char* name;
+        bool hasValue;
+        std::function<void(const char*)> set;
+    };
+
+    const Option* Find(const char* name) const
+    {
+        for (auto& option : options)
+        {
+            if (std::strcmp(option.name, name) == 0)
+                return &option;
+        }
+        return nullptr;
+    }
+
+    const char* category;
+    std::vector<Option> options;
+};
+
+// Times one call of the function into a phase, in units of Period divided by the number of items it processed
+template<typename Period = std::milli, typename Function>
+void Measure(FrameStatistics& statistics, const std::string& phase, int count, Function&& function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    float time = std::chrono::duration<float, Period>(std::chrono::steady_clock::now() - start).count();
+    statistics.Add(phase, time / count);
+}
+
+template<typename Period = std::milli, typename Function>
+void Measure(FrameStatistics& statistics, const std::string& phase, Function&& function)
+{
+    Measure<Period>(statistics, phase, 1, std::forward<Function>(function));
+}
+
+// One line per phase with the mean, median and fastest sample
+inline void LogSummaries(const char* category, const FrameStatistics& statistics, std::initializer_list<const char*> phases,
+                         const char* unit)
+{
+    for (const char* phase : phases)
+    {
+        FrameStatistics::Summary summary = statistics.Summarize(phase);
+        LOG_INFO(category, "%-20s mean %8.3f %s, p50 %8.3f %s, min %8.3f %s", phase, summary.mean, unit, summary.p50, unit,
+                 summary.min, unit);
+    }
+}
+
+inline bool WriteResults(const char* category, const FrameStatistics& statistics, const std::string& path, nlohmann::json run)
+{
+    if (!statistics.WriteJson(path, std::move(run)))
+        return false;
+    LOG_INFO(category, "Results written to %s", path.c_str());
+    return true;
+}
+
+#endif //OPENGL_GAMEENGINE_BENCHMARKCOMMON_H
@@ -0,0 +1,171 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "GameObject/Scene.hpp"
+#include "Engine/Log.hpp"
+#include "Engine/AllocationCounter.hpp"
+#include "Benchmark/BenchmarkCommon.h"
+
+// Command line options of a spawn and despawn benchmark run
+struct ChurnBenchmarkSettings
+{
+    int objects = 10000;    // Live roots, every one of them has children
+    int children = 2;
+    int churn = 1000;       // Roots destroyed and spawned again every frame
+    int frames = 200;
+    int warmup = 20;        // Frames until the pools and buffers reached their size
+    unsigned int seed = 1;
+    std::string outputPath = "churn_benchmark.json";
+};
+
+// Spins the object, its data is attached to the entity and updated by a system
+class SpinComponent : public GameComponent
+{
+public:
+    struct Spin
+    {
+        float angle;
+        float speed;
+    };
+
+    explicit SpinComponent(float speed) : speed(speed) { enabled = true; }
+
+    bool Attach(EntityRegistry& entities, Entity entity) override
+    {
+        entities.Add<Spin>(entity, 0.0f, speed);
+        entities.AddSystem(Rotate);
+        return true;
+    }
+
+    static void Rotate(EntityRegistry& entities)
+    {
+        entities.Each<Transform, Spin>([](Entity, Transform& transform, Spin& spin) {
+            spin.angle += spin.speed;
+            transform.SetRotation(glm::quat(glm::vec3(0.0f, spin.angle, 0.0f)));
+        });
+    }
+
+private:
+    float speed;
+};
+
+// Stays on the virtual Update path
+class TickComponent : public GameComponent
+{
+public:
+    void Update(Transform& transform) override { ticks++; }
+
+    int ticks = 0;
+};
+
+// Destroys and spawns objects with pooled components every frame and counts the heap allocations doing so
+class ChurnBenchmark
+{
+public:
+    explicit ChurnBenchmark(const ChurnBenchmarkSettings& settings) : settings(settings), random(settings.seed)
+    {
+        roots.reserve(settings.objects);
+        for (int i = 0; i < settings.objects; i++)
+            roots.push_back(Spawn());
+        scene.Update();
+    }
+
+    void Run()
+    {
+        for (int frame = 0; frame < settings.warmup + settings.frames; frame++)
+        {
+            long allocationsBefore = AllocationCounter::GetCount();
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < settings.churn; i++)
+            {
+                int root = (int)(random() % roots.size());
+                Despawn(roots[root]);
+                roots[root] = Spawn();
+            }
+            scene.Update();
+
+            float time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            long allocations = AllocationCounter::GetCount() - allocationsBefore;
+            if (frame < settings.warmup)
+                continue;
+            statistics.Add("frame", time);
+            statistics.Add("allocations", (float)allocations);
+        }
+
+        FrameStatistics::Summary frame = statistics.Summarize("frame");
+        FrameStatistics::Summary allocations = statistics.Summarize("allocations");
+        LOG_INFO("ChurnBenchmark", "%d objects, %d respawned per frame: mean %.3f ms, p99 %.3f ms, allocations per frame mean %.1f, max %.0f",
+                 scene.GetGameObjectCount(), settings.churn * (1 + settings.children), frame.mean, frame.p99, allocations.mean, allocations.max);
+
+        WriteResults("ChurnBenchmark", statistics, settings.outputPath, {
+                {"objects", settings.objects},
+                {"children", settings.children},
+                {"churn", settings.churn},
+                {"frames", settings.frames},
+                {"warmup", settings.warmup},
+                {"seed", settings.seed}
+        });
+    }
+
+private:
+    Handle<GameObject> Spawn()
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        GameObject* root = scene.CreateGameObject();
+        root->SetPosition(glm::vec3(unit(random), 0.0f, unit(random)) * 100.0f);
+        root->AddComponent<SpinComponent>(unit(random) * 0.1f);
+        root->AddComponent<TickComponent>();
+        for (int i = 0; i < settings.children; i++)
+        {
+            GameObject* child = scene.CreateGameObject();
+            child->SetPosition(glm::vec3(0.0f, 1.0f + i, 0.0f));
+            child->AddComponent<SpinComponent>(unit(random) * 0.1f);
+            root->AddChild(child);
+        }
+        return root->GetHandle();
+    }
+
+    void Despawn(Handle<GameObject> handle)
+    {
+        GameObject* root = scene.GetGameObject(handle);
+        for (GameObject* child = root->GetFirstChild(); child != nullptr; child = child->GetNextSibling())
+            scene.DestroyGameObject(child);
+        scene.DestroyGameObject(root);
+    }
+
+    ChurnBenchmarkSettings settings;
+    std::mt19937 random;
+    Scene scene;
+    std::vector<Handle<GameObject>> roots;
+    FrameStatistics statistics;
+};
+
+// [--objects n] [--children n] [--churn n] [--frames n] [--warmup n] [--seed n] [--output file.json]
+ChurnBenchmarkSettings ParseChurnBenchmarkSettings(int argc, char** argv)
+{
+    ChurnBenchmarkSettings settings;
+    BenchmarkOptions options("ChurnBenchmark");
+    options.Add("--objects", settings.objects, 1);
+    options.Add("--children", settings.children);
+    options.Add("--churn", settings.churn);
+    options.Add("--frames", settings.frames, 1);
+    options.Add("--warmup", settings.warmup);
+    options.Add("--seed", settings.seed);
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    ChurnBenchmark benchmark(ParseChurnBenchmarkSettings(argc, argv));
+    benchmark.Run();
+    Log::Flush();
+    return 0;
+}
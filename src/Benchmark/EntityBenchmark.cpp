@@ -0,0 +1,184 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Engine/EntityRegistry.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+#include "Benchmark/BenchmarkCommon.h"
+
+// Command line options of an entity benchmark run
+struct EntityBenchmarkSettings
+{
+    int entities = 100000;
+    float lightShare = 0.01f;   // Share of the entities that also carry a light, the rest only move
+    int repetitions = 100;
+    unsigned int workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    unsigned int seed = 1;
+    std::string outputPath = "entity_benchmark.json";
+};
+
+// Compares updating objects through virtual component calls, the way GameObject used to, against the entity
+// registry's serial and parallel iteration over the same per frame work
+class EntityBenchmark
+{
+public:
+    explicit EntityBenchmark(const EntityBenchmarkSettings& settings) : settings(settings), jobSystem(settings.workers)
+    {
+        std::mt19937 random(settings.seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> share(0.0f, 1.0f);
+        for (int i = 0; i < settings.entities; i++)
+        {
+            Motion motion{glm::vec3(unit(random), 0.0f, unit(random)), glm::vec3(unit(random), unit(random), unit(random))};
+            bool hasLight = share(random) < settings.lightShare;
+
+            objects.emplace_back();
+            objects.back().components.push_back(std::make_unique<MotionComponent>(motion));
+            if (hasLight)
+                objects.back().components.push_back(std::make_unique<LightComponent>());
+
+            Entity entity = entities.Create();
+            entities.Add<Motion>(entity, motion);
+            if (hasLight)
+                entities.Add<Light>(entity, glm::vec3(0.0f), 0.0f);
+        }
+    }
+
+    void Run()
+    {
+        for (int repetition = 0; repetition < settings.repetitions; repetition++)
+        {
+            Measure(statistics, "virtual components", [this]() {
+                for (auto& object : objects)
+                {
+                    for (auto& component : object.components)
+                        component->Update(object.transform);
+                }
+            });
+
+            Measure(statistics, "entities", [this]() {
+                entities.Each<Motion>([](Entity, Motion& motion) {
+                    motion.Step();
+                });
+                entities.Each<Motion, Light>([](Entity, Motion& motion, Light& light) {
+                    light.Follow(motion);
+                });
+            });
+
+            Measure(statistics, "entities parallel", [this]() {
+                entities.ParallelEach<Motion>(jobSystem, [](Entity, Motion& motion) {
+                    motion.Step();
+                });
+                entities.ParallelEach<Motion, Light>(jobSystem, [](Entity, Motion& motion, Light& light) {
+                    light.Follow(motion);
+                });
+            });
+        }
+
+        LogSummaries("EntityBenchmark", statistics, {"virtual components", "entities", "entities parallel"}, "ms");
+
+        WriteResults("EntityBenchmark", statistics, settings.outputPath, {
+                {"entities", settings.entities},
+                {"lightShare", settings.lightShare},
+                {"repetitions", settings.repetitions},
+                {"threads", jobSystem.GetThreadCount()},
+                {"seed", settings.seed}
+        });
+    }
+
+private:
+    struct Motion
+    {
+        glm::vec3 position;
+        glm::vec3 velocity;
+
+        void Step()
+        {
+            position += velocity * TIME_STEP;
+        }
+    };
+
+    struct Light
+    {
+        glm::vec3 position;
+        float intensity;
+
+        void Follow(const Motion& motion)
+        {
+            position = motion.position + glm::vec3(0.0f, 1.0f, 0.0f);
+            intensity = 1.0f;
+        }
+    };
+
+    // Stand-in for the old GameObject, a transform copied into every virtual call
+    struct ObjectTransform
+    {
+        glm::mat4 matrix = glm::mat4(1.0f);
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+    };
+
+    class Component
+    {
+    public:
+        virtual ~Component() = default;
+        virtual void Update(ObjectTransform transform) = 0;
+    };
+
+    class MotionComponent : public Component
+    {
+    public:
+        explicit MotionComponent(const Motion& motion) : motion(motion) {}
+        void Update(ObjectTransform transform) override { motion.Step(); }
+        Motion motion;
+    };
+
+    class LightComponent : public Component
+    {
+    public:
+        void Update(ObjectTransform transform) override { light.Follow({transform.position, glm::vec3(0.0f)}); }
+        Light light{};
+    };
+
+    struct Object
+    {
+        ObjectTransform transform;
+        std::vector<std::unique_ptr<Component>> components;
+    };
+
+    static constexpr float TIME_STEP = 1.0f / 60.0f;
+
+    EntityBenchmarkSettings settings;
+    JobSystem jobSystem;
+    EntityRegistry entities;
+    std::vector<Object> objects;
+    FrameStatistics statistics;
+};
+
+// [--entities n] [--lights share] [--repetitions n] [--workers n] [--seed n] [--output file.json]
+EntityBenchmarkSettings ParseEntityBenchmarkSettings(int argc, char** argv)
+{
+    EntityBenchmarkSettings settings;
+    BenchmarkOptions options("EntityBenchmark");
+    options.Add("--entities", settings.entities, 1);
+    options.Add("--lights", settings.lightShare, 0.0f, 1.0f);
+    options.Add("--repetitions", settings.repetitions, 1);
+    options.Add("--workers", settings.workers);
+    options.Add("--seed", settings.seed);
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    EntityBenchmark benchmark(ParseEntityBenchmarkSettings(argc, argv));
+    benchmark.Run();
+    Log::Flush();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <string>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <colony/plf_colony.h>
+
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+#include "Benchmark/BenchmarkCommon.h"
+
+// Command line options of a job system benchmark run
+struct JobBenchmarkSettings
+{
+    int jobs = 10000;       // Jobs per repetition
+    int repetitions = 100;
+    int elements = 100000;  // Elements of the parallel for cases
+    unsigned int workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    std::string outputPath = "job_benchmark.json";
+};
+
+// Measures the scheduling overhead of the job system, every case reports nanoseconds per job or per element
+class JobBenchmark
+{
+public:
+    explicit JobBenchmark(const JobBenchmarkSettings& settings) : settings(settings), jobSystem(settings.workers)
+    {
+        values.resize(settings.elements, 1.0f);
+        for (int i = 0; i < settings.elements; i++)
+            colony.insert(1.0f);
+    }
+
+    void Run()
+    {
+        for (int repetition = 0; repetition < settings.repetitions; repetition++)
+        {
+            // Independent empty jobs, the cost of queuing, stealing and counting a job
+            Measure<std::nano>(statistics, "empty jobs", settings.jobs, [this]() {
+                JobCounter counter;
+                for (int i = 0; i < settings.jobs; i++)
+                    jobSystem.Run([]() {}, &counter);
+                jobSystem.Wait(counter);
+            });
+
+            // Each job waits for the previous one, the latency of releasing a dependent job
+            std::vector<JobCounter> counters(CHAIN_LENGTH);
+            Measure<std::nano>(statistics, "dependency chain", CHAIN_LENGTH, [this, &counters]() {
+                jobSystem.Run([]() {}, &counters[0]);
+                for (int i = 1; i < CHAIN_LENGTH; i++)
+                    jobSystem.Run([]() {}, counters[i - 1], &counters[i]);
+                jobSystem.Wait(counters.back());
+            });
+            // The last job can finish while an earlier counter is still queuing its continuation
+            for (JobCounter& counter : counters)
+                jobSystem.Wait(counter);
+
+            // Jobs spawning jobs, how well the deques spread work that starts on a single worker
+            Measure<std::nano>(statistics, "nested jobs", settings.jobs, [this]() {
+                JobCounter counter;
+                int perJob = std::max(1, settings.jobs / NESTED_PARENTS);
+                for (int i = 0; i < NESTED_PARENTS; i++)
+                {
+                    jobSystem.Run([this, perJob, &counter]() {
+                        for (int j = 1; j < perJob; j++)
+                            jobSystem.Run([]() {}, &counter);
+                    }, &counter);
+                }
+                jobSystem.Wait(counter);
+            });
+
+            Measure<std::nano>(statistics, "serial for", settings.elements, [this]() {
+                for (float& value : values)
+                    value = std::sqrt(value + 1.0f);
+            });
+
+            Measure<std::nano>(statistics, "parallel for", settings.elements, [this]() {
+                jobSystem.ParallelFor(settings.elements, PARALLEL_FOR_CHUNK, [this](int begin, int end) {
+                    for (int i = begin; i < end; i++)
+                        values[i] = std::sqrt(values[i] + 1.0f);
+                });
+            });
+
+            Measure<std::nano>(statistics, "parallel for colony", settings.elements, [this]() {
+                jobSystem.ParallelFor(colony.begin(), colony.end(), PARALLEL_FOR_CHUNK, [](float& value) {
+                    value = std::sqrt(value + 1.0f);
+                });
+            });
+        }
+
+        LogSummaries("JobBenchmark", statistics, {"empty jobs", "dependency chain", "nested jobs", "serial for", "parallel for",
+                                                  "parallel for colony"}, "ns");
+
+        WriteResults("JobBenchmark", statistics, settings.outputPath, {
+                {"jobs", settings.jobs},
+                {"repetitions", settings.repetitions},
+                {"elements", settings.elements},
+                {"threads", jobSystem.GetThreadCount()},
+                {"unit", "ns per job or element"}
+        });
+    }
+
+private:
+    static constexpr int CHAIN_LENGTH = 1000;
+    static constexpr int NESTED_PARENTS = 16;
+    static constexpr int PARALLEL_FOR_CHUNK = 1024;
+
+    JobBenchmarkSettings settings;
+    JobSystem jobSystem;
+    FrameStatistics statistics;
+    std::vector<float> values;
+    plf::colony<float> colony;
+};
+
+// [--jobs n] [--repetitions n] [--elements n] [--workers n] [--output file.json]
+JobBenchmarkSettings ParseJobBenchmarkSettings(int argc, char** argv)
+{
+    JobBenchmarkSettings settings;
+    BenchmarkOptions options("JobBenchmark");
+    options.Add("--jobs", settings.jobs, 1);
+    options.Add("--repetitions", settings.repetitions, 1);
+    options.Add("--elements", settings.elements, 1);
+    options.Add("--workers", settings.workers);
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    JobBenchmark benchmark(ParseJobBenchmarkSettings(argc, argv));
+    benchmark.Run();
+    Log::Flush();
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Engine/OcclusionBuffer.hpp"
+#include "Engine/OccluderMesh.hpp"
+#include "Engine/FrameAllocator.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+#include "Benchmark/BenchmarkCommon.h"
+
+// Command line options of an occlusion culling benchmark run
+struct OcclusionBenchmarkSettings
+{
+    int objects = 20000;        // Bounds tested against the buffer every frame
+    int occluders = 200;        // Blocks standing on the terrain, next to the terrain itself
+    int resolution = 32;        // Grid resolution the terrain occluder is simplified with
+    int width = 256;            // Size of the occlusion buffer
+    int height = 128;
+    int frames = 200;
+    unsigned int workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    unsigned int seed = 1;
+    std::string outputPath = "occlusion_benchmark.json";
+};
+
+// Rasterizes a hilly terrain and blocks standing on it into the occlusion buffer and tests scattered object bounds
+// against it, from a camera circling low over the terrain. Needs no GL context.
+class OcclusionBenchmark
+{
+public:
+    explicit OcclusionBenchmark(const OcclusionBenchmarkSettings& settings) : settings(settings),
+    jobSystem(settings.workers), buffer(settings.width, settings.height)
+    {
+        std::mt19937 random(settings.seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        std::vector<SourceMesh> terrainMeshes = {MakeTerrain()};
+        terrain = OccluderMesh::Simplify(terrainMeshes, terrainMeshes[0].GetBounds(), settings.resolution);
+        std::vector<SourceMesh> blockMeshes = {MakeBlock()};
+        block = OccluderMesh::Simplify(blockMeshes, blockMeshes[0].GetBounds(), 2);
+        LOG_INFO("OcclusionBenchmark", "Terrain occluder %zu of %zu triangles, block occluder %zu of %zu triangles",
+                 terrain.GetTriangleCount(), terrainMeshes[0].indices.size() / 3, block.GetTriangleCount(),
+                 blockMeshes[0].indices.size() / 3);
+
+        for (int i = 0; i < settings.occluders; i++)
+        {
+            glm::vec2 position = glm::vec2(unit(random), unit(random)) * TERRAIN_SIZE * 0.45f;
+            blocks.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(position.x, Height(position.x, position.y), position.y)));
+        }
+        for (int i = 0; i < settings.objects; i++)
+        {
+            glm::vec2 position = glm::vec2(unit(random), unit(random)) * TERRAIN_SIZE * 0.45f;
+            glm::vec3 base = glm::vec3(position.x, Height(position.x, position.y), position.y);
+            objects.emplace_back(base - glm::vec3(0.5f, 0.0f, 0.5f), base + glm::vec3(0.5f, 1.0f, 0.5f));
+        }
+    }
+
+    void Run()
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)settings.width / settings.height, 0.1f, 500.0f);
+        for (int frame = 0; frame < settings.frames; frame++)
+        {
+            float angle = glm::two_pi<float>() * frame / settings.frames;
+            glm::vec3 eye = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * TERRAIN_SIZE * 0.3f;
+            eye.y = Height(eye.x, eye.z) + 2.0f;
+            glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, eye.y, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            buffer.Begin(projection * view);
+            buffer.AddOccluder(&terrain, glm::mat4(1.0f));
+            for (auto& model : blocks)
+                buffer.AddOccluder(&block, model);
+            Measure(statistics, "rasterize", [this]() {
+                buffer.Rasterize(jobSystem);
+            });
+
+            int occluded = 0;
+            Measure(statistics, "test", [this, &occluded]() {
+                for (auto& bounds : objects)
+                    occluded += buffer.IsVisible(bounds) ? 0 : 1;
+            });
+            statistics.Add("occluded share", (float)occluded / std::max(1, settings.objects));
+            FrameAllocator::GetInstance().Reset();
+        }
+
+        LogSummaries("OcclusionBenchmark", statistics, {"rasterize", "test"}, "ms");
+        LOG_INFO("OcclusionBenchmark", "%.1f%% of the objects occluded on average",
+                 statistics.Summarize("occluded share").mean * 100.0f);
+
+        WriteResults("OcclusionBenchmark", statistics, settings.outputPath, {
+                {"objects", settings.objects},
+                {"occluders", settings.occluders},
+                {"resolution", settings.resolution},
+                {"terrainTriangles", terrain.GetTriangleCount()},
+                {"width", buffer.GetWidth()},
+                {"height", buffer.GetHeight()},
+                {"frames", settings.frames},
+                {"threads", jobSystem.GetThreadCount()},
+                {"seed", settings.seed}
+        });
+    }
+
+private:
+    struct SourceVertex
+    {
+        glm::vec3 position;
+    };
+
+    struct SourceMesh
+    {
+        std::vector<SourceVertex> vertices;
+        std::vector<unsigned int> indices;
+
+        AABB GetBounds() const
+        {
+            AABB bounds;
+            for (auto& vertex : vertices)
+                bounds.Extend(vertex.position);
+            return bounds;
+        }
+    };
+
+    static float Height(float x, float z)
+    {
+        return 6.0f * std::sin(x * 0.05f) * std::cos(z * 0.04f) + 2.0f * std::sin(x * 0.17f + z * 0.11f);
+    }
+
+    static SourceMesh MakeTerrain()
+    {
+        SourceMesh mesh;
+        for (int z = 0; z <= TERRAIN_RESOLUTION; z++)
+        {
+            for (int x = 0; x <= TERRAIN_RESOLUTION; x++)
+            {
+                float px = (x / (float)TERRAIN_RESOLUTION - 0.5f) * TERRAIN_SIZE;
+                float pz = (z / (float)TERRAIN_RESOLUTION - 0.5f) * TERRAIN_SIZE;
+                mesh.vertices.push_back({glm::vec3(px, Height(px, pz), pz)});
+            }
+        }
+        for (int z = 0; z < TERRAIN_RESOLUTION; z++)
+        {
+            for (int x = 0; x < TERRAIN_RESOLUTION; x++)
+            {
+                unsigned int current = z * (TERRAIN_RESOLUTION + 1) + x;
+                unsigned int below = current + TERRAIN_RESOLUTION + 1;
+                mesh.indices.insert(mesh.indices.end(), {current, below, current + 1, current + 1, below, below + 1});
+            }
+        }
+        return mesh;
+    }
+
+    // A 4 x 6 x 4 block standing on the origin, counter-clockwise seen from outside
+    static SourceMesh MakeBlock()
+    {
+        SourceMesh mesh;
+        for (int i = 0; i < 8; i++)
+            mesh.vertices.push_back({glm::vec3(i & 1 ? 2.0f : -2.0f, i & 2 ? 6.0f : 0.0f, i & 4 ? 2.0f : -2.0f)});
+        mesh.indices = {0, 1, 5, 0, 5, 4,   2, 6, 7, 2, 7, 3,   0, 2, 3, 0, 3, 1,
+                        4, 5, 7, 4, 7, 6,   0, 4, 6, 0, 6, 2,   1, 3, 7, 1, 7, 5};
+        return mesh;
+    }
+
+    static constexpr int TERRAIN_RESOLUTION = 128;
+    static constexpr float TERRAIN_SIZE = 400.0f;
+
+    OcclusionBenchmarkSettings settings;
+    JobSystem jobSystem;
+    OcclusionBuffer buffer;
+    OccluderMesh terrain;
+    OccluderMesh block;
+    std::vector<glm::mat4> blocks;
+    std::vector<AABB> objects;
+    FrameStatistics statistics;
+};
+
+// [--objects n] [--occluders n] [--resolution n] [--width w] [--height h] [--frames n] [--workers n] [--seed n]
+// [--output file.json]
+OcclusionBenchmarkSettings ParseOcclusionBenchmarkSettings(int argc, char** argv)
+{
+    OcclusionBenchmarkSettings settings;
+    BenchmarkOptions options("OcclusionBenchmark");
+    options.Add("--objects", settings.objects);
+    options.Add("--occluders", settings.occluders);
+    options.Add("--resolution", settings.resolution, 1);
+    options.Add("--width", settings.width, 8);
+    options.Add("--height", settings.height, 8);
+    options.Add("--frames", settings.frames, 1);
+    options.Add("--workers", settings.workers);
+    options.Add("--seed", settings.seed);
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    OcclusionBenchmark benchmark(ParseOcclusionBenchmarkSettings(argc, argv));
+    benchmark.Run();
+    Log::Flush();
+    return 0;
+}
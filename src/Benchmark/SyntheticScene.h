@@ -0,0 +1,163 @@
+#ifndef OPENGL_GAMEENGINE_SYNTHETICSCENE_H
+#define OPENGL_GAMEENGINE_SYNTHETICSCENE_H
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Engine/model.hpp"
+#include "Engine/light.hpp"
+#include "GameObject/Scene.hpp"
+#include "GameComponent/ModelRenderer.hpp"
+#include "GameComponent/LightRenderer.hpp"
+
+struct SyntheticSceneSettings
+{
+    int objects = 2000;
+    int models = 8;             // Unique meshes the objects are spread over
+    int pointLights = 64;
+    int spotLights = 16;
+    float movingShare = 0.25f;  // Share of the hierarchies that move every frame
+    int hierarchyDepth = 1;     // Objects per parent-child chain
+    float spacing = 4.0f;       // Average distance between hierarchies on the ground plane
+    unsigned int seed = 1;
+};
+
+// UV sphere generated on the fly, the detail varies per model so every one of them is a separate mesh
+class ProceduralModel : public Model
+{
+public:
+    ProceduralModel(int rings, int segments, float radius)
+    {
+        std::vector<Vertex> vertices;
+        for (int ring = 0; ring <= rings; ring++)
+        {
+            float phi = glm::pi<float>() * ring / rings;
+            for (int segment = 0; segment <= segments; segment++)
+            {
+                float theta = 2.0f * glm::pi<float>() * segment / segments;
+                glm::vec3 normal = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+                vertices.push_back({normal * radius, normal, glm::vec2((float)segment / segments, (float)ring / rings)});
+            }
+        }
+
+        std::vector<unsigned int> indices;
+        for (int ring = 0; ring < rings; ring++)
+        {
+            for (int segment = 0; segment < segments; segment++)
+            {
+                unsigned int current = ring * (segments + 1) + segment;
+                unsigned int below = current + segments + 1;
+                indices.insert(indices.end(), {current, below, current + 1, current + 1, below, below + 1});
+            }
+        }
+        _meshes.emplace_back(vertices, indices);
+    }
+};
+
+// Fills a scene with randomly placed objects, lights and hierarchies for benchmark runs.
+// The same settings and seed always build the same scene.
+class SyntheticScene
+{
+public:
+    SyntheticScene(Scene& scene, Shader& shader, const SyntheticSceneSettings& settings) : settings(settings)
+    {
+        std::mt19937 random(settings.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        for (int i = 0; i < std::max(1, settings.models); i++)
+            models.push_back(std::make_unique<ProceduralModel>(6 + 2 * i, 8 + 4 * i, 0.5f + 0.5f * unit(random)));
+
+        int depth = std::max(1, settings.hierarchyDepth);
+        int hierarchyCount = (settings.objects + depth - 1) / depth;
+        extent = std::sqrt((float)hierarchyCount) * settings.spacing * 0.5f;
+
+        int created = 0;
+        for (int i = 0; i < hierarchyCount; i++)
+        {
+            glm::vec3 position = glm::vec3((unit(random) * 2.0f - 1.0f) * extent, 0.0f, (unit(random) * 2.0f - 1.0f) * extent);
+            bool moving = unit(random) < settings.movingShare;
+
+            GameObject* parent = nullptr;
+            for (int level = 0; level < depth && created < settings.objects; level++, created++)
+            {
+                GameObject* gameObject = scene.CreateGameObject();
+                Model* model = models[random() % models.size()].get();
+                gameObject->AddComponent<ModelRenderer>(model, shader);
+                if (parent != nullptr)
+                {
+                    parent->AddChild(gameObject);
+                    // Stacked and slightly rotated, so moving the root moves the whole chain
+                    gameObject->SetPosition(glm::vec3(0.0f, 1.5f, 0.0f));
+                    gameObject->SetRotation(glm::quat(glm::vec3(0.0f, 0.3f, 0.0f)));
+                }
+                else
+                {
+                    gameObject->SetPosition(position);
+                    if (moving)
+                        movers.push_back({gameObject, position, unit(random) * glm::two_pi<float>()});
+                }
+                gameObject->SetStatic(!moving);
+                parent = gameObject;
+            }
+        }
+
+        glm::vec3 white = glm::vec3(1.0f);
+        DirectionalLight directionalLight(glm::vec3(-1.0f, -1.0f, -1.0f), white * 0.2f, white * 0.8f, white);
+        scene.CreateGameObject()->AddComponent<DirectionalLightRenderer>(directionalLight, shader);
+
+        for (int i = 0; i < settings.pointLights; i++)
+        {
+            glm::vec3 color = glm::vec3(unit(random), unit(random), unit(random));
+            PointLight light(RandomLightPosition(random), CONST_ATTENUATION, color * 0.05f, color, color);
+            scene.CreateGameObject()->AddComponent<PointLightRenderer>(light, shader);
+        }
+
+        for (int i = 0; i < settings.spotLights; i++)
+        {
+            glm::vec3 color = glm::vec3(unit(random), unit(random), unit(random));
+            SpotLight light(RandomLightPosition(random), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(20.0f)),
+                            glm::cos(glm::radians(30.0f)), CONST_ATTENUATION, color * 0.05f, color, color);
+            scene.CreateGameObject()->AddComponent<SpotLightRenderer>(light, shader);
+        }
+    }
+
+    // Moves the roots of the moving hierarchies, their children follow through the transform hierarchy
+    void Animate(float time)
+    {
+        for (auto& mover : movers)
+        {
+            float angle = time + mover.phase;
+            mover.gameObject->SetPosition(mover.origin + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * settings.spacing * 0.5f);
+            mover.gameObject->SetRotation(glm::quat(glm::vec3(0.0f, angle, 0.0f)));
+        }
+    }
+
+    // Half the side of the square the hierarchies are placed in
+    float GetExtent() const { return extent; }
+    int GetMovingCount() const { return (int)movers.size(); }
+
+private:
+    struct Mover
+    {
+        GameObject* gameObject;
+        glm::vec3 origin;
+        float phase;
+    };
+
+    glm::vec3 RandomLightPosition(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        return glm::vec3((unit(random) * 2.0f - 1.0f) * extent, 2.0f + unit(random) * 6.0f, (unit(random) * 2.0f - 1.0f) * extent);
+    }
+
+    SyntheticSceneSettings settings;
+    std::vector<std::unique_ptr<ProceduralModel>> models;
+    std::vector<Mover> movers;
+    float extent = 0.0f;
+};
+
+#endif //OPENGL_GAMEENGINE_SYNTHETICSCENE_H
@@ -0,0 +1,159 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Engine/TransformHierarchy.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+#include "Benchmark/BenchmarkCommon.h"
+
+// Command line options of a transform hierarchy benchmark run
+struct TransformBenchmarkSettings
+{
+    int nodes = 100000;
+    int fanout = 4;             // Children per node, the tree is filled breadth first
+    float dirtyShare = 0.01f;   // Share of the nodes moved in the sparse case
+    int repetitions = 100;
+    unsigned int workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    unsigned int seed = 1;
+    std::string outputPath = "transform_benchmark.json";
+};
+
+// Compares the level by level hierarchy update against recursively updating node objects, the way GameObject used to
+class TransformBenchmark
+{
+public:
+    explicit TransformBenchmark(const TransformBenchmarkSettings& settings) : settings(settings), jobSystem(settings.workers)
+    {
+        std::mt19937 random(settings.seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (int i = 0; i < settings.nodes; i++)
+        {
+            int parent = i == 0 ? TransformHierarchy::NONE : (i - 1) / settings.fanout;
+            glm::vec3 position = glm::vec3(unit(random), unit(random), unit(random));
+            glm::quat rotation = glm::quat(glm::vec3(0.0f, unit(random), 0.0f));
+
+            int node = hierarchy.Create();
+            if (parent != TransformHierarchy::NONE)
+                hierarchy.SetParent(node, nodes[parent]);
+            hierarchy.SetPosition(node, position);
+            hierarchy.SetRotation(node, rotation);
+            nodes.push_back(node);
+
+            recursiveNodes.push_back({position, rotation, glm::vec3(1.0f), glm::mat4(1.0f), glm::mat3(1.0f), {}});
+            if (parent != TransformHierarchy::NONE)
+                recursiveNodes[parent].children.push_back(i);
+        }
+        hierarchy.Update(jobSystem);
+
+        int dirtyCount = std::max(1, (int)(settings.nodes * settings.dirtyShare));
+        std::uniform_int_distribution<int> anyNode(0, settings.nodes - 1);
+        for (int i = 0; i < dirtyCount; i++)
+            dirtyNodes.push_back(anyNode(random));
+    }
+
+    void Run()
+    {
+        for (int repetition = 0; repetition < settings.repetitions; repetition++)
+        {
+            float angle = repetition * 0.01f;
+
+            Measure(statistics, "recursive", [this, angle]() {
+                recursiveNodes[0].position.x = angle;
+                UpdateRecursive(0, glm::mat4(1.0f));
+            });
+
+            Measure(statistics, "hierarchy full", [this, angle]() {
+                hierarchy.SetPosition(nodes[0], glm::vec3(angle, 0.0f, 0.0f));
+                hierarchy.Update(jobSystem);
+            });
+
+            Measure(statistics, "hierarchy sparse", [this, angle]() {
+                for (int node : dirtyNodes)
+                    hierarchy.SetRotation(nodes[node], glm::quat(glm::vec3(0.0f, angle, 0.0f)));
+                hierarchy.Update(jobSystem);
+            });
+
+            Measure(statistics, "hierarchy idle", [this]() {
+                hierarchy.Update(jobSystem);
+            });
+
+            // What every draw used to pay for its normal matrix, the hierarchy only computes it when a node moves
+            Measure(statistics, "inverse per draw", [this]() {
+                for (RecursiveNode& node : recursiveNodes)
+                    node.normalMatrix = glm::mat3(glm::transpose(glm::inverse(node.modelMatrix)));
+            });
+        }
+
+        LogSummaries("TransformBenchmark", statistics, {"recursive", "hierarchy full", "hierarchy sparse", "hierarchy idle",
+                                                        "inverse per draw"}, "ms");
+
+        WriteResults("TransformBenchmark", statistics, settings.outputPath, {
+                {"nodes", settings.nodes},
+                {"fanout", settings.fanout},
+                {"dirtyShare", settings.dirtyShare},
+                {"repetitions", settings.repetitions},
+                {"threads", jobSystem.GetThreadCount()},
+                {"seed", settings.seed}
+        });
+    }
+
+private:
+    struct RecursiveNode
+    {
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 scale;
+        glm::mat4 modelMatrix;
+        glm::mat3 normalMatrix;
+        std::vector<int> children;
+    };
+
+    void UpdateRecursive(int index, const glm::mat4& parentMatrix)
+    {
+        RecursiveNode& node = recursiveNodes[index];
+        glm::mat4 translation = glm::translate(glm::mat4(1.0f), node.position);
+        glm::mat4 rotation = glm::mat4_cast(node.rotation);
+        glm::mat4 scale = glm::scale(glm::mat4(1.0f), node.scale);
+        node.modelMatrix = parentMatrix * translation * rotation * scale;
+        for (int child : node.children)
+            UpdateRecursive(child, node.modelMatrix);
+    }
+
+    TransformBenchmarkSettings settings;
+    JobSystem jobSystem;
+    TransformHierarchy hierarchy;
+    std::vector<int> nodes;
+    std::vector<int> dirtyNodes;
+    std::vector<RecursiveNode> recursiveNodes;
+    FrameStatistics statistics;
+};
+
+// [--nodes n] [--fanout n] [--dirty share] [--repetitions n] [--workers n] [--seed n] [--output file.json]
+TransformBenchmarkSettings ParseTransformBenchmarkSettings(int argc, char** argv)
+{
+    TransformBenchmarkSettings settings;
+    BenchmarkOptions options("TransformBenchmark");
+    options.Add("--nodes", settings.nodes, 1);
+    options.Add("--fanout", settings.fanout, 1);
+    options.Add("--dirty", settings.dirtyShare, 0.0f, 1.0f);
+    options.Add("--repetitions", settings.repetitions, 1);
+    options.Add("--workers", settings.workers);
+    options.Add("--seed", settings.seed);
+    options.Add("--output", settings.outputPath);
+    options.Parse(argc, argv);
+    return settings;
+}
+
+int main(int argc, char** argv)
+{
+    TransformBenchmark benchmark(ParseTransformBenchmarkSettings(argc, argv));
+    benchmark.Run();
+    Log::Flush();
+    return 0;
+}
@@ -3,6 +3,10 @@
 
 #include "Window/Window.h"
 #include "Renderer/Renderer.h"
+#include "Core/RenderThread.h"
+#include "Engine/Profiler.hpp"
+#include "Engine/FrameAllocator.hpp"
+#include "Engine/Log.hpp"
 
 class Application {
 public:
@@ -15,11 +19,18 @@ public:
     virtual void PostLoop() {};
     virtual void Setup() = 0;
 
+    // Submits the frames on a render thread while the main thread prepares the next one. PostLoop then runs on the
+    // render thread after each submitted frame, so it may only touch GL and the renderer's statistics.
+    void SetRenderThreadEnabled(bool enabled) { renderThreadEnabled = enabled; }
+    bool IsRenderThreadEnabled() { return renderThreadEnabled; }
+
 protected:
     void Init();
+    void RunThreaded();
 
     Window& window;
     Renderer* renderer;
+    bool renderThreadEnabled = false;
 };
 
 #include "Application.h"
@@ -36,23 +47,92 @@ void Application::Init() {
 }
 
 void Application::OnRender() {
+    PROFILE_FUNCTION();
     renderer->Render();
     renderer->PostRender();
 }
 
 void Application::Run() {
+    Profiler::SetThreadName("Main");
     Setup();
-    while (window.IsAlive())
+    // The forward path draws from the scene while submitting, the main thread would update it at the same time
+    if (renderThreadEnabled && renderer->GetRenderingPath() == RenderingPath::FORWARD)
+    {
+        LOG_WARNING("Application", "The forward path can not submit on a render thread, running serial");
+        renderThreadEnabled = false;
+    }
+    if (renderThreadEnabled)
     {
-        PreLoop();
+        RunThreaded();
+        return;
+    }
 
-        OnLoop();
+    while (window.IsAlive())
+    {
+        PROFILE_ZONE("Frame");
+        renderer->BeginFrame();
+        {
+            PROFILE_ZONE("PreLoop");
+            PreLoop();
+        }
+        {
+            PROFILE_ZONE("OnLoop");
+            OnLoop();
+        }
         OnRender();
+        {
+            PROFILE_ZONE("PostLoop");
+            PostLoop();
+        }
+        {
+            PROFILE_ZONE("Swap buffers");
+            window.OnUpdate();
+        }
+        FrameAllocator::GetInstance().Reset();
+    }
+    window.Shutdown();
+}
 
-        PostLoop();
+void Application::RunThreaded() {
+    renderer->SetSubmitOnRenderThread(true);
+    RenderThread renderThread(window, Renderer::FRAMES_IN_FLIGHT);
+    renderThread.Start([this]() {
+        {
+            PROFILE_ZONE("Submit");
+            renderer->Submit();
+        }
+        {
+            PROFILE_ZONE("PostLoop");
+            PostLoop();
+        }
+        {
+            PROFILE_ZONE("Swap buffers");
+            window.SwapBuffers();
+        }
+    });
 
-        window.OnUpdate();
+    while (window.IsAlive())
+    {
+        renderThread.WaitForFreeFrame();
+        PROFILE_ZONE("Frame");
+        renderer->BeginFrame();
+        {
+            PROFILE_ZONE("PreLoop");
+            PreLoop();
+        }
+        {
+            PROFILE_ZONE("OnLoop");
+            OnLoop();
+        }
+        renderer->Prepare();
+        renderer->PostRender();
+        renderThread.QueueFrame();
+        window.PollEvents();
+        // The render thread allocates from its own frame allocator, see RenderThread
+        FrameAllocator::GetInstance().Reset();
     }
+    renderThread.Stop();
+    renderer->SetSubmitOnRenderThread(false);
     window.Shutdown();
 }
 
@@ -0,0 +1,118 @@
+#ifndef OPENGL_GAMEENGINE_FRAMESTATISTICS_H
+#define OPENGL_GAMEENGINE_FRAMESTATISTICS_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "Engine/Log.hpp"
+#include "nlohmann/json.hpp"
+
+// Per frame timings of named phases, summarized into the numbers benchmark runs are compared by
+class FrameStatistics
+{
+public:
+    struct Summary
+    {
+        int samples = 0;
+        float mean = 0.0f;
+        float min = 0.0f;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+    // Adds a time in milliseconds to the phase, the phase is created on first use
+    void Add(const std::string& phase, float milliseconds)
+    {
+        for (auto& entry : phases)
+        {
+            if (entry.name == phase)
+            {
+                entry.samples.push_back(milliseconds);
+                return;
+            }
+        }
+        phases.push_back({phase, {milliseconds}});
+    }
+
+    Summary Summarize(const std::string& phase) const
+    {
+        for (auto& entry : phases)
+        {
+            if (entry.name == phase)
+                return Summarize(entry.samples);
+        }
+        return Summary();
+    }
+
+    static Summary Summarize(std::vector<float> samples)
+    {
+        Summary summary;
+        if (samples.empty())
+            return summary;
+
+        std::sort(samples.begin(), samples.end());
+        float sum = 0.0f;
+        for (float sample : samples)
+            sum += sample;
+
+        summary.samples = (int)samples.size();
+        summary.mean = sum / samples.size();
+        summary.min = samples.front();
+        summary.p50 = Percentile(samples, 0.50f);
+        summary.p95 = Percentile(samples, 0.95f);
+        summary.p99 = Percentile(samples, 0.99f);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    // Summary of every phase, keyed by phase name
+    nlohmann::json ToJson() const
+    {
+        nlohmann::json json = nlohmann::json::object();
+        for (auto& entry : phases)
+        {
+            Summary summary = Summarize(entry.samples);
+            json[entry.name] = {{"samples", summary.samples}, {"mean", summary.mean}, {"min", summary.min}, {"p50", summary.p50},
+                                {"p95", summary.p95}, {"p99", summary.p99}, {"max", summary.max}};
+        }
+        return json;
+    }
+
+    // Writes the phase summaries under "phases" next to the given run description
+    bool WriteJson(const std::string& path, nlohmann::json run = nlohmann::json::object()) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Statistics", "Could not open %s", path.c_str());
+            return false;
+        }
+        run["phases"] = ToJson();
+        file << run.dump(4);
+        return true;
+    }
+
+    void Clear() { phases.clear(); }
+
+private:
+    struct Phase
+    {
+        std::string name;
+        std::vector<float> samples;
+    };
+
+    // Nearest rank percentile of sorted samples
+    static float Percentile(const std::vector<float>& sorted, float percentile)
+    {
+        int rank = (int)std::ceil(percentile * sorted.size()) - 1;
+        return sorted[std::clamp(rank, 0, (int)sorted.size() - 1)];
+    }
+
+    std::vector<Phase> phases;
+};
+
+#endif //OPENGL_GAMEENGINE_FRAMESTATISTICS_H
@@ -1,5 +1,7 @@
 #include "Core/OpenGLContext.h"
-#include <iostream>
+#include "Engine/Log.hpp"
+
+#include <cstdlib>
 
 void OpenGLContext::Init(GLFWwindow *glfwWindow)
 {
@@ -9,7 +11,8 @@ void OpenGLContext::Init(GLFWwindow *glfwWindow)
     /* Initialize GLAD */
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
-        std::cout << "Failed to initialize GLAD!" << std::endl;
+        LOG_ERROR("OpenGL", "Failed to initialize GLAD!");
+        std::exit(EXIT_FAILURE);
     }
 
     /* GL Enable */
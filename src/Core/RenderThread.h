@@ -0,0 +1,110 @@
+#ifndef OPENGL_GAMEENGINE_RENDERTHREAD_H
+#define OPENGL_GAMEENGINE_RENDERTHREAD_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Window/Window.h"
+#include "Engine/Profiler.hpp"
+#include "Engine/FrameAllocator.hpp"
+
+// Owns the GL context and submits the frames the main thread prepared. The main thread waits for a free
+// snapshot before preparing a frame and queues it when done, so it runs at most framesInFlight frames ahead.
+// Frame memory of the render thread comes from an allocator of its own, reset after every submitted frame, since
+// the main thread resets its one while the render thread may still submit.
+class RenderThread
+{
+public:
+    RenderThread(Window& window, int framesInFlight) : window(window), framesInFlight(framesInFlight) {}
+
+    ~RenderThread() { Stop(); }
+
+    // Moves the GL context of the window from the calling thread to the render thread
+    void Start(std::function<void()> renderFrame)
+    {
+        this->renderFrame = std::move(renderFrame);
+        freeFrames = framesInFlight;
+        queuedFrames = 0;
+        stopping = false;
+        glfwMakeContextCurrent(nullptr);
+        thread = std::thread(&RenderThread::Loop, this);
+    }
+
+    // Submits the queued frames and hands the GL context back to the calling thread
+    void Stop()
+    {
+        if (!thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_one();
+        thread.join();
+        glfwMakeContextCurrent(window.GetGLFWWindow());
+    }
+
+    // Blocks until the render thread has submitted the frame that last used the next snapshot
+    void WaitForFreeFrame()
+    {
+        PROFILE_FUNCTION();
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [this]() { return freeFrames > 0; });
+        freeFrames--;
+    }
+
+    // Hands the prepared snapshot to the render thread
+    void QueueFrame()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queuedFrames++;
+        }
+        queued.notify_one();
+    }
+
+private:
+    void Loop()
+    {
+        Profiler::SetThreadName("Render");
+        frameAllocator.MakeCurrent();
+        glfwMakeContextCurrent(window.GetGLFWWindow());
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued.wait(lock, [this]() { return queuedFrames > 0 || stopping; });
+                if (queuedFrames == 0)
+                    break;
+                queuedFrames--;
+            }
+
+            renderFrame();
+            frameAllocator.Reset();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                freeFrames++;
+            }
+            released.notify_one();
+        }
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    Window& window;
+    int framesInFlight;
+    std::function<void()> renderFrame;
+    std::thread thread;
+    FrameAllocator frameAllocator;
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable released;
+    int freeFrames = 0;
+    int queuedFrames = 0;
+    bool stopping = false;
+};
+
+#endif //OPENGL_GAMEENGINE_RENDERTHREAD_H
@@ -5,7 +5,7 @@
 #include "Gui/SceneWidget.hpp"
 #include "GameObject/GameObject.hpp"
 #include <imgui/imgui.h>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <string>
 #include <glm/glm.hpp>
 #include <imgui_filebrowser/imfilebrowser.h>
@@ -86,7 +86,7 @@ private:
         if (_fileDialog.HasSelected())
         {
             _modelPath = _fileDialog.GetSelected().string();
-            std::cout<<_modelPath<<std::endl;
+            LOG_INFO("Editor", "Selected model %s", _modelPath.c_str());
             std::replace( _modelPath.begin(), _modelPath.end(), '\\', '/');
             _fileDialog.ClearSelected();
             _isModelLoaded = true;
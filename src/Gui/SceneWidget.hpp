@@ -5,7 +5,7 @@
 #include "Engine/FBO.hpp"
 #include "GameObject/GameObject.hpp"
 #include <imgui/imgui.h>
-#include <iostream>
+#include "Engine/Log.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 
@@ -74,7 +74,7 @@ private:
         if ((_size.x < _prevSize.x || _size.y < _prevSize.y) ||
             (_size.x > _prevSize.x || _size.y > _prevSize.y))
         {
-            std::cout << "Scene panel resized: X-" << _size.x << " Y-" << _size.y << std::endl;
+            LOG_DEBUG("Editor", "Scene panel resized: X-%.0f Y-%.0f", _size.x, _size.y);
             _sceneBuffer.resize((int)_size.x, (int)_size.y);
             _prevSize = _size;
         }
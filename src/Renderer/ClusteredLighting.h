@@ -0,0 +1,249 @@
+#ifndef OPENGL_GAMEENGINE_CLUSTEREDLIGHTING_H
+#define OPENGL_GAMEENGINE_CLUSTEREDLIGHTING_H
+
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Engine/SSBO.hpp"
+#include "Engine/light.hpp"
+#include "Engine/shader.hpp"
+#include "Engine/Log.hpp"
+
+// Point and spot lights of a frame in the layout the lighting shaders read
+class LightList
+{
+public:
+    // Layouts match the std430 structs in clusterCulling.comp and lightingPassClustered.frag
+    struct GpuPointLight
+    {
+        glm::vec4 positionRange;
+        glm::vec4 ambient;
+        glm::vec4 diffuse;
+        glm::vec4 specular;
+        glm::vec4 attenuation;
+    };
+
+    // Inner cut off in directionCutOff.w, outer cut off in attenuation.w
+    struct GpuSpotLight
+    {
+        glm::vec4 positionRange;
+        glm::vec4 directionCutOff;
+        glm::vec4 ambient;
+        glm::vec4 diffuse;
+        glm::vec4 specular;
+        glm::vec4 attenuation;
+    };
+
+    void Clear()
+    {
+        pointLights.clear();
+        spotLights.clear();
+    }
+
+    void AddPointLight(PointLight& light)
+    {
+        pointLights.push_back({
+            glm::vec4(light.getPosition(), light.getRange()),
+            glm::vec4(light.getAmbient(), 0.0f),
+            glm::vec4(light.getDiffuse(), 0.0f),
+            glm::vec4(light.getSpecular(), 0.0f),
+            glm::vec4(light.getConstAttenuation(), light.getLinAttenuation(), light.getQuadAttenuation(), 0.0f)
+        });
+    }
+
+    void AddSpotLight(SpotLight& light)
+    {
+        spotLights.push_back({
+            glm::vec4(light.getPosition(), light.getRange()),
+            glm::vec4(light.getDirection(), light.getInnerCutOff()),
+            glm::vec4(light.getAmbient(), 0.0f),
+            glm::vec4(light.getDiffuse(), 0.0f),
+            glm::vec4(light.getSpecular(), 0.0f),
+            glm::vec4(light.getConstAttenuation(), light.getLinAttenuation(), light.getQuadAttenuation(), light.getOuterCutOff())
+        });
+    }
+
+    int GetPointLightCount() const { return (int)pointLights.size(); }
+    int GetSpotLightCount() const { return (int)spotLights.size(); }
+    const std::vector<GpuPointLight>& GetPointLights() const { return pointLights; }
+    const std::vector<GpuSpotLight>& GetSpotLights() const { return spotLights; }
+
+private:
+    std::vector<GpuPointLight> pointLights;
+    std::vector<GpuSpotLight> spotLights;
+};
+
+// Light index storage shared by the lists of a culling pass. Each list claims its range through an atomic counter that
+// adds up the full demand even when it overflows, the counter is read back without waiting once the GPU is done with
+// it and the storage grows to the demand before a later frame. Lists that do not fit keep the part that does.
+class LightIndexList
+{
+public:
+    explicit LightIndexList(const char* category, unsigned int maxListLights) : category(category),
+    maxListLights(maxListLights)
+    {
+        Counter zero;
+        counter.SetData(&zero, sizeof(zero));
+    }
+
+    ~LightIndexList()
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+    }
+
+    // Grows the storage from the last counts read back and at least to lists * min(lights, averageLights) indices,
+    // then clears the counter for the next dispatch
+    void Prepare(unsigned int lists, unsigned int lights, unsigned int averageLights)
+    {
+        ReadBack();
+        size_t indices = std::max((size_t)lists * std::min(lights, averageLights), requiredIndices);
+        lightIndices.Reserve(std::max(indices, (size_t)1) * sizeof(unsigned int));
+        Counter zero;
+        counter.SetData(&zero, sizeof(zero));
+    }
+
+    void BindIndices(unsigned int binding) { lightIndices.bindBase(binding); }
+    void BindCounter(unsigned int binding) { counter.bindBase(binding); }
+
+    // Marks the end of the dispatch that filled the counter
+    void EndDispatch()
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    unsigned int GetCapacity() const { return (unsigned int)(lightIndices.GetCapacity() / sizeof(unsigned int)); }
+
+private:
+    // Layout matches LightIndexCounter in the culling shaders
+    struct Counter
+    {
+        unsigned int lightIndexCount = 0;   // Indices the lists asked for
+        unsigned int truncatedLists = 0;    // Lists with more than maxListLights lights
+    };
+
+    // Reads the counter of the last dispatch if the GPU has finished it, skips the frame otherwise
+    void ReadBack()
+    {
+        if (fence == nullptr)
+            return;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        glDeleteSync(fence);
+        fence = nullptr;
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+
+        Counter counts;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter.ID);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counts), &counts);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        if (counts.lightIndexCount > GetCapacity())
+        {
+            // Headroom for lights moving into more lists
+            requiredIndices = (size_t)counts.lightIndexCount + counts.lightIndexCount / 2;
+            LOG_INFO(category, "Light index list grows to %zu indices", requiredIndices);
+        }
+        if (counts.truncatedLists > 0 && !truncationLogged)
+        {
+            LOG_WARNING(category, "%u light lists reach more than %u lights, the rest of their lights are dropped",
+                        counts.truncatedLists, maxListLights);
+            truncationLogged = true;
+        }
+    }
+
+    const char* category;
+    unsigned int maxListLights;
+    SSBO lightIndices;
+    SSBO counter;
+    GLsync fence = nullptr;
+    size_t requiredIndices = 0;
+    bool truncationLogged = false;
+};
+
+// Bins the point and spot lights of the frame into a froxel grid with a compute shader,
+// the clustered lighting pass then only evaluates the lights of each pixel's cluster.
+class ClusteredLighting
+{
+public:
+    static constexpr unsigned int CLUSTER_X = 16;
+    static constexpr unsigned int CLUSTER_Y = 9;
+    static constexpr unsigned int CLUSTER_Z = 24;
+    static constexpr unsigned int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+    // Average number of lights per cluster the index list starts with room for, it grows to what the clusters use
+    static constexpr unsigned int AVERAGE_CLUSTER_LIGHTS = 64;
+    // Matches MAX_CLUSTER_LIGHTS in clusterCulling.comp
+    static constexpr unsigned int MAX_CLUSTER_LIGHTS = 256;
+
+    ClusteredLighting() : cullingShader("./resources/shaders/clusterCulling.comp"),
+    lightIndices("ClusteredLighting", MAX_CLUSTER_LIGHTS)
+    {
+        lightGrid.Reserve(CLUSTER_COUNT * sizeof(glm::uvec4));
+    }
+
+    // Uploads the lights and builds the per cluster light lists
+    void Cull(const LightList& lights, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane)
+    {
+        const std::vector<LightList::GpuPointLight>& pointLights = lights.GetPointLights();
+        const std::vector<LightList::GpuSpotLight>& spotLights = lights.GetSpotLights();
+        clusterNear = nearPlane;
+        clusterFar = farPlane;
+
+        pointLightBuffer.SetData(pointLights.data(), pointLights.size() * sizeof(LightList::GpuPointLight));
+        spotLightBuffer.SetData(spotLights.data(), spotLights.size() * sizeof(LightList::GpuSpotLight));
+        lightIndices.Prepare(CLUSTER_COUNT, (unsigned int)(pointLights.size() + spotLights.size()), AVERAGE_CLUSTER_LIGHTS);
+        BindBuffers();
+        lightIndices.BindCounter(4);
+
+        cullingShader.bind();
+        cullingShader.setUniformMat4("u_view", view);
+        cullingShader.setUniformMat4("u_inverseProjection", glm::inverse(projection));
+        cullingShader.setUniformUInt3("u_clusterCount", glm::uvec3(CLUSTER_X, CLUSTER_Y, CLUSTER_Z));
+        cullingShader.setUniformFloat("u_clusterNear", clusterNear);
+        cullingShader.setUniformFloat("u_clusterFar", clusterFar);
+        cullingShader.setUniformInt("u_pointLightsNum", (int)pointLights.size());
+        cullingShader.setUniformInt("u_spotLightsNum", (int)spotLights.size());
+        cullingShader.setUniformUInt("u_lightIndexCapacity", lightIndices.GetCapacity());
+        cullingShader.dispatch((CLUSTER_COUNT + BATCH_SIZE - 1) / BATCH_SIZE);
+        cullingShader.unbind();
+        lightIndices.EndDispatch();
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // Binds the light lists for the lighting pass and sets the cluster lookup uniforms
+    void SetClustersInShader(Shader& shader, const glm::mat4& view, const glm::vec2& viewportSize)
+    {
+        BindBuffers();
+        shader.bind();
+        shader.setUniformMat4("u_view", view);
+        shader.setUniformFloat2("u_viewportSize", viewportSize);
+        shader.setUniformUInt3("u_clusterCount", glm::uvec3(CLUSTER_X, CLUSTER_Y, CLUSTER_Z));
+        shader.setUniformFloat("u_clusterNear", clusterNear);
+        shader.setUniformFloat("u_clusterFar", clusterFar);
+        shader.unbind();
+    }
+
+private:
+    static constexpr unsigned int BATCH_SIZE = 128;
+
+    void BindBuffers()
+    {
+        pointLightBuffer.bindBase(0);
+        spotLightBuffer.bindBase(1);
+        lightGrid.bindBase(2);
+        lightIndices.BindIndices(3);
+    }
+
+    Shader cullingShader;
+    SSBO pointLightBuffer;
+    SSBO spotLightBuffer;
+    SSBO lightGrid;
+    LightIndexList lightIndices;
+    float clusterNear = 0.1f;
+    float clusterFar = 1000.0f;
+};
+
+#endif //OPENGL_GAMEENGINE_CLUSTEREDLIGHTING_H
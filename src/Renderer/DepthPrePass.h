@@ -0,0 +1,106 @@
+#ifndef OPENGL_GAMEENGINE_DEPTHPREPASS_H
+#define OPENGL_GAMEENGINE_DEPTHPREPASS_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include "Engine/GpuProfiler.hpp"
+
+enum class DepthPrePassMode
+{
+    OFF,
+    ON,
+    AUTOMATIC   // On while the measured overdraw is high enough to pay for drawing the geometry twice
+};
+
+// Decides whether the scene passes start with a depth only pass, after which the shading pass tests GL_EQUAL and only
+// shades the visible surface. Overdraw is measured with a GL_SAMPLES_PASSED query around the pass that writes the depth,
+// that is the pre-pass when it runs and the shading pass otherwise. Both count the fragments that pass the depth test in
+// draw order, which is what the shading pass pays for without a pre-pass. Results are read FRAME_LATENCY frames later.
+// The pre-pass replays the recorded draws. The forward pass draws through the components' shaders and tests GL_LEQUAL
+// instead, their shaders should still compute gl_Position like depthPrePass.vert to gain from it.
+class DepthPrePass
+{
+public:
+    static constexpr int FRAME_LATENCY = GpuProfiler::FRAME_LATENCY;
+
+    struct Settings
+    {
+        float enableOverdraw = 1.6f;    // Depth tested fragments per pixel above which the pre-pass is turned on
+        float disableOverdraw = 1.3f;   // And below which it is turned off again
+    };
+
+    DepthPrePass()
+    {
+        glGenQueries(FRAME_LATENCY, queries);
+    }
+
+    ~DepthPrePass()
+    {
+        glDeleteQueries(FRAME_LATENCY, queries);
+    }
+
+    DepthPrePass(const DepthPrePass&) = delete;
+    DepthPrePass& operator=(const DepthPrePass&) = delete;
+
+    // Reads the result of the query set this frame is about to reuse and picks whether this frame has a pre-pass
+    void BeginFrame(float pixelCount)
+    {
+        slot = (slot + 1) % FRAME_LATENCY;
+        // A result that is still not available is dropped, the query is reused regardless
+        if (issued[slot])
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                GLuint64 samples = 0;
+                glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &samples);
+                overdraw = (float)samples / std::max(pixels[slot], 1.0f);
+            }
+            issued[slot] = false;
+        }
+        pixels[slot] = pixelCount;
+
+        if (mode != DepthPrePassMode::AUTOMATIC)
+            enabled = mode == DepthPrePassMode::ON;
+        else if (overdraw > settings.enableOverdraw)
+            enabled = true;
+        else if (overdraw < settings.disableOverdraw)
+            enabled = false;
+    }
+
+    // Surround the pass that writes the depth of the frame
+    void BeginMeasure()
+    {
+        glBeginQuery(GL_SAMPLES_PASSED, queries[slot]);
+    }
+
+    void EndMeasure()
+    {
+        glEndQuery(GL_SAMPLES_PASSED);
+        issued[slot] = true;
+    }
+
+    // Whether the current frame draws a pre-pass
+    bool IsEnabled() const { return enabled; }
+    // Depth tested fragments per pixel of the render area in the latest measured frame
+    float GetOverdraw() const { return overdraw; }
+
+    void SetMode(DepthPrePassMode mode) { this->mode = mode; }
+    DepthPrePassMode GetMode() const { return mode; }
+    void SetSettings(const Settings& settings) { this->settings = settings; }
+    const Settings& GetSettings() const { return settings; }
+
+private:
+    Settings settings;
+    DepthPrePassMode mode = DepthPrePassMode::AUTOMATIC;
+    bool enabled = false;
+    float overdraw = 0.0f;
+
+    GLuint queries[FRAME_LATENCY] = {};
+    bool issued[FRAME_LATENCY] = {};
+    float pixels[FRAME_LATENCY] = {};
+    int slot = 0;
+};
+
+#endif //OPENGL_GAMEENGINE_DEPTHPREPASS_H
@@ -0,0 +1,81 @@
+#ifndef OPENGL_GAMEENGINE_DYNAMICRESOLUTION_H
+#define OPENGL_GAMEENGINE_DYNAMICRESOLUTION_H
+
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// Picks the render scale of the resolution dependent passes so the GPU frame time stays under a budget.
+// The frame is modelled as a fixed part (shadows) plus a scaled part whose cost follows the pixel count,
+// so the new scale is the one the scaled passes would need to fit in what the fixed part leaves over.
+class DynamicResolution
+{
+public:
+    struct Settings
+    {
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float frameBudget = 16.0f;      // Milliseconds of GPU time per frame
+        float headroom = 0.9f;          // Fraction of the budget the controller aims for
+        float maxScaleStepUp = 0.05f;   // Growing is slow, a spike drops the scale in a single frame
+        int upscaleDelay = 8;           // Frames under the target between two steps up
+    };
+
+    DynamicResolution() = default;
+    explicit DynamicResolution(const Settings& settings) : settings(settings), scale(settings.maxScale) {}
+
+    // Feeds the GPU times of a finished frame and the scale it was rendered at.
+    // The times arrive a few frames late, so the scale they belong to is passed along with them.
+    void Update(float fixedTime, float scaledTime, float measuredScale)
+    {
+        if (!enabled)
+        {
+            scale = settings.maxScale;
+            return;
+        }
+
+        // Smoothed for growing so single fast frames do not make the scale wobble
+        float frameTime = fixedTime + scaledTime;
+        averageFrameTime = averageFrameTime <= 0.0f ? frameTime : averageFrameTime + (frameTime - averageFrameTime) * SMOOTHING;
+
+        float target = settings.frameBudget * settings.headroom;
+        float available = std::max(target - fixedTime, target * 0.1f);
+        // Pixel count goes with the square of the scale
+        float desiredScale = scaledTime > 0.0f ? measuredScale * std::sqrt(available / scaledTime) : settings.maxScale;
+        desiredScale = glm::clamp(desiredScale, settings.minScale, settings.maxScale);
+
+        if (desiredScale < scale && frameTime > target)
+        {
+            scale = desiredScale;
+            framesUnderTarget = 0;
+        }
+        else if (std::max(frameTime, averageFrameTime) < target && ++framesUnderTarget >= settings.upscaleDelay)
+        {
+            scale = std::min(desiredScale, scale + settings.maxScaleStepUp);
+            framesUnderTarget = 0;
+        }
+    }
+
+    // Size of the scaled render area, never zero
+    glm::vec2 GetRenderSize(const glm::vec2& viewportSize) const
+    {
+        return glm::vec2(std::max(1.0f, std::floor(viewportSize.x * scale)), std::max(1.0f, std::floor(viewportSize.y * scale)));
+    }
+
+    void SetEnabled(bool enabled) { this->enabled = enabled; }
+    bool IsEnabled() const { return enabled; }
+    void SetSettings(const Settings& settings) { this->settings = settings; scale = glm::clamp(scale, settings.minScale, settings.maxScale); }
+    const Settings& GetSettings() const { return settings; }
+    float GetScale() const { return scale; }
+
+private:
+    static constexpr float SMOOTHING = 0.1f;
+
+    Settings settings;
+    bool enabled = true;
+    float scale = 1.0f;
+    float averageFrameTime = 0.0f;
+    int framesUnderTarget = 0;
+};
+
+#endif //OPENGL_GAMEENGINE_DYNAMICRESOLUTION_H
@@ -0,0 +1,517 @@
+#ifndef OPENGL_GAMEENGINE_FRAMEGRAPH_H
+#define OPENGL_GAMEENGINE_FRAMEGRAPH_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include "Engine/FrameAllocator.hpp"
+#include "Engine/Log.hpp"
+
+// Size and format of a render target
+struct TextureDesc
+{
+    int width = 0;
+    int height = 0;
+    GLenum format = GL_RGBA8;
+
+    bool operator==(const TextureDesc& other) const
+    {
+        return width == other.width && height == other.height && format == other.format;
+    }
+
+    bool HasStencil() const { return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8; }
+
+    // Estimate of the video memory, drivers pad three channel formats to four
+    size_t GetBytes() const
+    {
+        size_t bytesPerPixel = 4;
+        switch (format)
+        {
+            case GL_R8: bytesPerPixel = 1; break;
+            case GL_RG8: case GL_R16F: bytesPerPixel = 2; break;
+            case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: bytesPerPixel = 8; break;
+            case GL_RGBA32F: bytesPerPixel = 16; break;
+            default: break;
+        }
+        return (size_t)width * (size_t)height * bytesPerPixel;
+    }
+};
+
+// Textures and framebuffers of the frame graph. A texture is handed out for the lifetime of one resource and comes
+// back to the pool afterwards, so resources of equal description whose lifetimes do not overlap share a texture.
+// Plain GL has no placement of textures in shared memory, aliasing is therefore limited to equal descriptions.
+class RenderTargetPool
+{
+public:
+    // Textures unused for this many frames are deleted, a resize leaves the old sizes behind for a while only
+    static constexpr unsigned int UNUSED_FRAMES = 60;
+    static constexpr int MAX_COLOR_ATTACHMENTS = 4;
+
+    RenderTargetPool() = default;
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    unsigned int Acquire(const TextureDesc& desc)
+    {
+        for (auto& target : targets)
+        {
+            if (!target.inUse && target.desc == desc)
+            {
+                target.inUse = true;
+                target.lastUsed = frame;
+                return target.texture;
+            }
+        }
+
+        Target target;
+        target.desc = desc;
+        target.lastUsed = frame;
+        target.inUse = true;
+        glGenTextures(1, &target.texture);
+        glBindTexture(GL_TEXTURE_2D, target.texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, desc.format, desc.width, desc.height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        targets.push_back(target);
+        allocatedBytes += desc.GetBytes();
+        return target.texture;
+    }
+
+    void Release(unsigned int texture)
+    {
+        for (auto& target : targets)
+        {
+            if (target.texture == texture)
+                target.inUse = false;
+        }
+    }
+
+    // Framebuffer with the textures attached, created the first time the combination is asked for
+    unsigned int GetFramebuffer(const unsigned int* colors, int colorCount, unsigned int depth, bool depthStencil)
+    {
+        unsigned int attachments[MAX_COLOR_ATTACHMENTS + 1] = {};
+        std::copy(colors, colors + std::min(colorCount, MAX_COLOR_ATTACHMENTS), attachments);
+        attachments[MAX_COLOR_ATTACHMENTS] = depth;
+        for (auto& framebuffer : framebuffers)
+        {
+            if (std::equal(attachments, attachments + MAX_COLOR_ATTACHMENTS + 1, framebuffer.attachments))
+                return framebuffer.ID;
+        }
+
+        Framebuffer framebuffer;
+        std::copy(attachments, attachments + MAX_COLOR_ATTACHMENTS + 1, framebuffer.attachments);
+        glGenFramebuffers(1, &framebuffer.ID);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.ID);
+        GLenum drawBuffers[MAX_COLOR_ATTACHMENTS];
+        for (int i = 0; i < colorCount; i++)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colors[i], 0);
+            drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        }
+        if (depth != 0)
+            glFramebufferTexture2D(GL_FRAMEBUFFER, depthStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        if (colorCount > 0)
+        {
+            glDrawBuffers(colorCount, drawBuffers);
+        }
+        else
+        {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+
+        auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
+            LOG_ERROR("FrameGraph", "Framebuffer error: 0x%x", fboStatus);
+        framebuffers.push_back(framebuffer);
+        return framebuffer.ID;
+    }
+
+    // Deletes the textures that were not used for a while together with the framebuffers they are attached to
+    void EndFrame()
+    {
+        frame++;
+        for (int i = (int)targets.size() - 1; i >= 0; i--)
+        {
+            Target& target = targets[i];
+            if (target.inUse || frame - target.lastUsed < UNUSED_FRAMES)
+                continue;
+
+            ForgetTexture(target.texture);
+            glDeleteTextures(1, &target.texture);
+            allocatedBytes -= target.desc.GetBytes();
+            targets.erase(targets.begin() + i);
+        }
+    }
+
+    // Deletes the framebuffers the texture is attached to, imported textures need it before they are deleted
+    void ForgetTexture(unsigned int texture)
+    {
+        framebuffers.erase(std::remove_if(framebuffers.begin(), framebuffers.end(), [texture](const Framebuffer& framebuffer) {
+            bool attached = std::find(framebuffer.attachments, framebuffer.attachments + MAX_COLOR_ATTACHMENTS + 1,
+                                      texture) != framebuffer.attachments + MAX_COLOR_ATTACHMENTS + 1;
+            if (attached)
+                glDeleteFramebuffers(1, &framebuffer.ID);
+            return attached;
+        }), framebuffers.end());
+    }
+
+    size_t GetAllocatedBytes() const { return allocatedBytes; }
+    int GetTextureCount() const { return (int)targets.size(); }
+
+private:
+    struct Target
+    {
+        TextureDesc desc;
+        unsigned int texture = 0;
+        unsigned int lastUsed = 0;
+        bool inUse = false;
+    };
+
+    struct Framebuffer
+    {
+        unsigned int attachments[MAX_COLOR_ATTACHMENTS + 1] = {};
+        unsigned int ID = 0;
+    };
+
+    std::vector<Target> targets;
+    std::vector<Framebuffer> framebuffers;
+    unsigned int frame = 0;
+    size_t allocatedBytes = 0;
+};
+
+// Passes of a frame declared together with the resources they read and write. Compile culls the passes whose results
+// nobody reads, orders the others after the passes that write what they read and finds the first and last pass of every
+// resource. Execute then runs them with the render targets taken from the pool only for that span.
+//
+// The graph is built again every frame. Passes that write an imported resource or are marked with SideEffect are kept,
+// the others only when a kept pass reads what they write. Passes writing the same resource keep their declaration order,
+// a pass reading a resource runs after all passes writing it, unless it writes it too and is declared before them.
+class FrameGraph
+{
+public:
+    using Resource = int;
+    static constexpr Resource NONE = -1;
+
+    // Declares the accesses of the pass being added
+    class Builder
+    {
+    public:
+        Resource Read(Resource resource) { graph.AddAccess(pass, resource, false); return resource; }
+        Resource Write(Resource resource) { graph.AddAccess(pass, resource, true); return resource; }
+        // Keeps the pass even though nothing reads what it writes
+        void SideEffect() { graph.passes[pass].sideEffect = true; }
+
+    private:
+        friend class FrameGraph;
+        Builder(FrameGraph& graph, int pass) : graph(graph), pass(pass) {}
+
+        FrameGraph& graph;
+        int pass;
+    };
+
+    // Forgets the passes and resources of the previous frame, the pool keeps its textures
+    void Reset()
+    {
+        passes.clear();
+        resources.clear();
+        accesses.clear();
+        order.clear();
+        culledPasses = 0;
+    }
+
+    // Render target owned by the graph, only allocated while the passes using it run
+    Resource Create(const char* name, const TextureDesc& desc)
+    {
+        ResourceEntry resource;
+        resource.name = name;
+        resource.desc = desc;
+        resources.push_back(resource);
+        return (Resource)resources.size() - 1;
+    }
+
+    // Resource that outlives the frame, such as the output image or a cache. Texture 0 only orders the passes.
+    Resource Import(const char* name, unsigned int texture = 0, const TextureDesc& desc = TextureDesc())
+    {
+        ResourceEntry resource;
+        resource.name = name;
+        resource.desc = desc;
+        resource.texture = texture;
+        resource.imported = true;
+        resources.push_back(resource);
+        return (Resource)resources.size() - 1;
+    }
+
+    // Runs setup right away to declare the accesses, execute runs later with the graph. The execute callback is copied
+    // into the frame allocator and never destroyed, it may only capture references and pointers.
+    template<typename Setup, typename Execute>
+    void AddPass(const char* name, Setup&& setup, Execute&& execute)
+    {
+        using Callback = std::decay_t<Execute>;
+        static_assert(std::is_trivially_destructible<Callback>::value, "Pass callbacks are never destroyed");
+
+        Pass pass;
+        pass.name = name;
+        pass.callback = new (FrameAllocator::GetCurrent().Allocate(sizeof(Callback), alignof(Callback))) Callback(std::forward<Execute>(execute));
+        pass.invoke = [](void* callback, FrameGraph& graph) { (*static_cast<Callback*>(callback))(graph); };
+        passes.push_back(pass);
+        Builder builder(*this, (int)passes.size() - 1);
+        setup(builder);
+    }
+
+    void Compile()
+    {
+        CullPasses();
+        SortPasses();
+
+        for (auto& resource : resources)
+        {
+            resource.firstUse = -1;
+            resource.lastUse = -1;
+        }
+        for (int i = 0; i < (int)order.size(); i++)
+        {
+            for (auto& access : accesses)
+            {
+                if (access.pass != order[i])
+                    continue;
+                ResourceEntry& resource = resources[access.resource];
+                if (resource.firstUse < 0)
+                    resource.firstUse = i;
+                resource.lastUse = i;
+            }
+        }
+    }
+
+    void Execute()
+    {
+        for (int i = 0; i < (int)order.size(); i++)
+        {
+            for (auto& resource : resources)
+            {
+                if (!resource.imported && resource.firstUse == i)
+                    resource.texture = pool.Acquire(resource.desc);
+            }
+
+            Pass& pass = passes[order[i]];
+            pass.invoke(pass.callback, *this);
+
+            // Released right after the last use, a later resource of the same description takes the texture over
+            for (auto& resource : resources)
+            {
+                if (!resource.imported && resource.lastUse == i)
+                    pool.Release(resource.texture);
+            }
+        }
+        pool.EndFrame();
+    }
+
+    // Valid while the passes using the resource execute
+    unsigned int GetTexture(Resource resource) const { return resources[resource].texture; }
+    const TextureDesc& GetDesc(Resource resource) const { return resources[resource].desc; }
+
+    // Framebuffer rendering into the resources, NONE leaves out the depth attachment
+    unsigned int GetFramebuffer(std::initializer_list<Resource> colors, Resource depth = NONE)
+    {
+        unsigned int textures[RenderTargetPool::MAX_COLOR_ATTACHMENTS] = {};
+        int colorCount = 0;
+        for (Resource color : colors)
+        {
+            if (colorCount < RenderTargetPool::MAX_COLOR_ATTACHMENTS)
+                textures[colorCount++] = resources[color].texture;
+        }
+        unsigned int depthTexture = depth != NONE ? resources[depth].texture : 0;
+        bool depthStencil = depth != NONE && resources[depth].desc.HasStencil();
+        return pool.GetFramebuffer(textures, colorCount, depthTexture, depthStencil);
+    }
+
+    void BindFramebuffer(std::initializer_list<Resource> colors, Resource depth = NONE)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer(colors, depth));
+    }
+
+    RenderTargetPool& GetPool() { return pool; }
+    int GetPassCount() const { return (int)passes.size(); }
+    // Passes of the last compiled frame that did not run
+    int GetCulledPassCount() const { return culledPasses; }
+    // Declaration index of the pass that runs at position i, after Compile
+    int GetExecutionOrder(int i) const { return order[i]; }
+    int GetExecutedPassCount() const { return (int)order.size(); }
+    const char* GetPassName(int pass) const { return passes[pass].name; }
+
+private:
+    struct ResourceEntry
+    {
+        const char* name = "";
+        TextureDesc desc;
+        unsigned int texture = 0;
+        bool imported = false;
+        int readers = 0;        // Passes still reading it while culling
+        int firstUse = -1;      // Positions in the execution order
+        int lastUse = -1;
+    };
+
+    struct Access
+    {
+        int pass;
+        Resource resource;
+        bool read;
+        bool write;
+    };
+
+    struct Pass
+    {
+        const char* name = "";
+        void* callback = nullptr;
+        void (*invoke)(void*, FrameGraph&) = nullptr;
+        bool sideEffect = false;
+        bool culled = false;
+    };
+
+    void AddAccess(int pass, Resource resource, bool write)
+    {
+        for (auto& access : accesses)
+        {
+            // Reading and writing the same resource is a single read-modify-write access
+            if (access.pass == pass && access.resource == resource)
+            {
+                access.read = access.read || !write;
+                access.write = access.write || write;
+                return;
+            }
+        }
+        accesses.push_back({pass, resource, !write, write});
+    }
+
+    bool Writes(int pass, Resource resource) const
+    {
+        for (auto& access : accesses)
+        {
+            if (access.pass == pass && access.resource == resource && access.write)
+                return true;
+        }
+        return false;
+    }
+
+    // Reference counting from the resources nobody reads back to the passes that only produce them
+    void CullPasses()
+    {
+        for (auto& pass : passes)
+            pass.culled = false;
+        for (auto& resource : resources)
+            resource.readers = 0;
+        for (auto& access : accesses)
+        {
+            if (access.read)
+                resources[access.resource].readers++;
+        }
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int p = 0; p < (int)passes.size(); p++)
+            {
+                Pass& pass = passes[p];
+                if (pass.culled || pass.sideEffect)
+                    continue;
+
+                // A pass does not keep itself alive by reading what it writes
+                bool needed = false;
+                for (auto& access : accesses)
+                {
+                    const ResourceEntry& resource = resources[access.resource];
+                    if (access.pass == p && access.write && (resource.imported || resource.readers - (access.read ? 1 : 0) > 0))
+                        needed = true;
+                }
+                if (needed)
+                    continue;
+
+                pass.culled = true;
+                culledPasses++;
+                changed = true;
+                for (auto& access : accesses)
+                {
+                    if (access.pass == p && access.read)
+                        resources[access.resource].readers--;
+                }
+            }
+        }
+    }
+
+    bool DependsOn(int pass, int other) const
+    {
+        for (auto& access : accesses)
+        {
+            if (access.pass != pass)
+                continue;
+            if (!Writes(other, access.resource))
+                continue;
+            // Writers keep their declaration order, readers wait for every writer
+            if (!access.write || other < pass)
+                return true;
+        }
+        return false;
+    }
+
+    // Orders the passes that were kept after the passes they depend on, the earliest declared ready pass goes first
+    void SortPasses()
+    {
+        order.clear();
+        int remaining = 0;
+        for (auto& pass : passes)
+        {
+            if (!pass.culled)
+                remaining++;
+        }
+
+        while ((int)order.size() < remaining)
+        {
+            int next = -1;
+            for (int p = 0; p < (int)passes.size() && next < 0; p++)
+            {
+                if (passes[p].culled || std::find(order.begin(), order.end(), p) != order.end())
+                    continue;
+
+                bool ready = true;
+                for (int other = 0; other < (int)passes.size() && ready; other++)
+                {
+                    if (other != p && !passes[other].culled && DependsOn(p, other) &&
+                        std::find(order.begin(), order.end(), other) == order.end())
+                        ready = false;
+                }
+                if (ready)
+                    next = p;
+            }
+
+            if (next < 0)
+            {
+                LOG_ERROR("FrameGraph", "Passes depend on each other, running the rest in declaration order");
+                for (int p = 0; p < (int)passes.size(); p++)
+                {
+                    if (!passes[p].culled && std::find(order.begin(), order.end(), p) == order.end())
+                        order.push_back(p);
+                }
+                break;
+            }
+            order.push_back(next);
+        }
+    }
+
+    RenderTargetPool pool;
+    std::vector<Pass> passes;
+    std::vector<ResourceEntry> resources;
+    std::vector<Access> accesses;
+    std::vector<int> order;
+    int culledPasses = 0;
+};
+
+#endif //OPENGL_GAMEENGINE_FRAMEGRAPH_H
@@ -0,0 +1,70 @@
+#ifndef OPENGL_GAMEENGINE_FRAMESNAPSHOT_H
+#define OPENGL_GAMEENGINE_FRAMESNAPSHOT_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Engine/CommandList.hpp"
+#include "Engine/CascadedShadowMap.hpp"
+#include "Engine/light.hpp"
+#include "Renderer/ClusteredLighting.h"
+
+// How the scene is drawn and lit
+enum class RenderingPath
+{
+    DEFERRED,       // G-buffer followed by a lighting pass, see LightingMode
+    FORWARD,        // The components draw themselves with their own shaders, on the thread that prepares the frame
+    FORWARD_PLUS    // Depth pre-pass, per tile light lists and a forward shading pass reading only its tile's lights
+};
+
+// CPU side cost of a frame
+struct RenderStatistics
+{
+    float simulationTime = 0.0f;    // Milliseconds of the application's PreLoop and OnLoop
+    float sceneUpdateTime = 0.0f;
+    float cullingTime = 0.0f;
+    float recordTime = 0.0f;        // Recording the draws of the geometry and shadow passes
+    float submitTime = 0.0f;        // Replaying the recorded passes
+    int visibleObjects = 0;
+    int shadowCasters = 0;          // Summed over the shadow passes
+    int drawCommands = 0;           // Summed over every recorded pass
+    bool depthPrePass = false;      // Whether the scene pass started with a depth pre-pass
+    float overdraw = 0.0f;          // Depth tested fragments per pixel, measured a few frames earlier
+    int renderPasses = 0;           // Frame graph passes that ran
+    int culledPasses = 0;           // Frame graph passes nothing read the output of
+    float renderTargetMemory = 0.0f;    // Megabytes of pooled render targets, the imported ones not included
+};
+
+// Draws of a shadow map together with the cascades they were recorded for
+struct ShadowMapCommands
+{
+    explicit ShadowMapCommands(const CascadedShadowMap& shadowMap) : shadowMap(shadowMap) {}
+
+    // Copy taken after the cascades were fitted, shares the GL objects of the renderer's shadow map
+    CascadedShadowMap shadowMap;
+    unsigned int cascadeMask = 0;   // Cascades rendered this frame, 0 skips the shadow map
+    CommandList staticCasters;
+    CommandList dynamicCasters;
+};
+
+// Everything the GL passes of a frame read. The main thread fills it while preparing the frame and does not touch it
+// again until the frame has been submitted, so the render thread reads it without locking.
+struct FrameSnapshot
+{
+    glm::vec2 viewportSize = glm::vec2(0.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 viewPosition = glm::vec3(0.0f);
+    glm::vec3 viewDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+    // Path the frame was prepared for, switching paths only takes effect for the frames prepared afterwards
+    RenderingPath renderingPath = RenderingPath::DEFERRED;
+
+    CommandList geometryCommands;
+    std::vector<ShadowMapCommands> shadowMaps;
+
+    LightList lights;
+    DirectionalLight directionalLight = DirectionalLight(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+
+    RenderStatistics statistics;
+};
+
+#endif //OPENGL_GAMEENGINE_FRAMESNAPSHOT_H
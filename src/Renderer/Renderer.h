@@ -3,26 +3,66 @@
 
 #include "GameObject/Scene.hpp"
 #include "Engine/FBO.hpp"
-#include "Engine/GBuffer.hpp"
-#include "Engine/ShadowMap.hpp"
+#include "Engine/CascadedShadowMap.hpp"
+#include "Renderer/ClusteredLighting.h"
+#include "Renderer/TiledLighting.h"
+#include "Renderer/DynamicResolution.h"
+#include "Renderer/DepthPrePass.h"
+#include "Renderer/FrameGraph.h"
+#include "Renderer/FrameSnapshot.h"
+#include "Engine/Bounds.hpp"
+#include "Engine/LightVolumeMesh.hpp"
+#include "Engine/OcclusionBuffer.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/GpuProfiler.hpp"
+#include "Engine/CommandList.hpp"
+#include "Engine/Profiler.hpp"
 #include "Engine/camera.hpp"
 #include "Engine/shader.hpp"
 #include "Window/Window.h"
+#include <chrono>
+
+// How the deferred lighting pass accumulates the point and spot lights
+enum class LightingMode
+{
+    FULL_SCREEN,    // Every light for every pixel, limited by the uniform arrays of the shader
+    CLUSTERED,      // Per cluster light lists built by a compute shader
+    LIGHT_VOLUMES   // Stencil culled sphere and cone meshes, one draw per light
+};
 
 class Renderer {
 public:
     static Renderer* GetInstance();
     void SetViewportSize(glm::vec2& viewportSize);
 
+    // Frames prepared on the main thread while the render thread may still be submitting older ones
+    static constexpr int FRAMES_IN_FLIGHT = 2;
+
     void Init(Camera* mainCamera, Scene* mainScene, glm::vec2& viewPortSize);
+    // A frame is split in two halves. BeginFrame, PreRender and Prepare run on the main thread and fill the frame's snapshot
+    // from the scene, Submit runs on the thread owning the GL context and only reads the snapshot.
+    void BeginFrame();
     void PreRender();
+    void Prepare();
+    void Submit();
+    // Prepare and Submit on the calling thread
     void Render();
     void PostRender();
 
     void DrawToWindow(Window& window);
+    // RGB pixels of the last frame in the main FBO, bottom row first
+    void ReadFrame(std::vector<unsigned char>& pixels);
 
     FBO& GetFBO() { return mainFBO; }
-    GBuffer& GetGBuffer() { return gBuffer; }
+    FrameGraph& GetFrameGraph() { return frameGraph; }
+    OcclusionBuffer& GetOcclusionBuffer() { return occlusionBuffer; }
+    GpuProfiler& GetGpuProfiler() { return gpuProfiler; }
+    DynamicResolution& GetDynamicResolution() { return dynamicResolution; }
+    DepthPrePass& GetDepthPrePass() { return depthPrePass; }
+    // Size the scene passes render at this frame, the viewport size scaled by the dynamic resolution
+    glm::vec2 GetRenderSize() { return renderSize; }
+    // Statistics of the last submitted frame, read them on the thread that submits
+    const RenderStatistics& GetStatistics() { return statistics; }
     glm::mat4& GetView() { return view; }
     glm::mat4& GetProjection() { return projection; }
     float GetDeltaTime() { return deltaTime; }
@@ -33,6 +73,28 @@ public:
     int GetPointLightCount() { return pointLightCount; }
     int GetSpotLightCount() { return spotLightCount; }
 
+    // Lights of the prepared frame, submitted during the scene update
+    void SubmitDirectionalLight(DirectionalLight& light) { GetPreparedFrame().directionalLight = light; }
+    void SubmitPointLight(PointLight& light) { GetPreparedFrame().lights.AddPointLight(light); }
+    void SubmitSpotLight(SpotLight& light) { GetPreparedFrame().lights.AddSpotLight(light); }
+
+    void SetLightingMode(LightingMode mode) { lightingMode = mode; }
+    LightingMode GetLightingMode() { return lightingMode; }
+    // Applies to the frames prepared after the call. The forward path draws from the live scene while submitting,
+    // so it is refused while Submit runs on a render thread.
+    void SetRenderingPath(RenderingPath path)
+    {
+        if (path == RenderingPath::FORWARD && submitOnRenderThread)
+        {
+            LOG_WARNING("Renderer", "The forward path needs Prepare and Submit on the same thread, keeping the current path");
+            return;
+        }
+        renderingPath = path;
+    }
+    RenderingPath GetRenderingPath() { return renderingPath; }
+    // Set by the application while a render thread submits the prepared frames
+    void SetSubmitOnRenderThread(bool enabled) { submitOnRenderThread = enabled; }
+
     void AddShader(Shader* shader)
     {
         int i = 0;
@@ -46,15 +108,617 @@ public:
         }
     }
 
-    void AddShadowMap(DirectionalLight& light,  float projectionSize, float nearPlane = 0.1f, float farPlane = 300.0f)
+    void AddShadowMap(DirectionalLight& light, float shadowDistance, int cascadeCount = 4)
     {
-        ShadowMap shadowMap(2048, 2048, -light.getDirection(), projectionSize, nearPlane, farPlane);
+        CascadedShadowMap shadowMap(2048, light.getDirection(), cascadeCount, shadowDistance);
         shadowMaps.push_back(shadowMap);
+        for (auto& frame : frames)
+            frame.shadowMaps.emplace_back(shadowMap);
+        std::string name = "Shadow map " + std::to_string(shadowMaps.size() - 1);
+        shadowMapPasses.push_back(gpuProfiler.GetPassId(name));
+        staticShadowMapPasses.push_back(gpuProfiler.GetPassId(name + " static"));
     }
 
 private:
     Renderer();
 
+    FrameSnapshot& GetPreparedFrame() { return frames[preparedFrames % FRAMES_IN_FLIGHT]; }
+
+    // Feeds the GPU times that became available to the resolution controller and picks this frame's render size
+    void UpdateRenderScale()
+    {
+        gpuProfiler.BeginFrame();
+        int slot = renderFrame++ % GpuProfiler::FRAME_LATENCY;
+        if (gpuProfiler.GetResultFrames() != lastResultFrames)
+        {
+            lastResultFrames = gpuProfiler.GetResultFrames();
+            float scaledTime = gpuProfiler.GetPassTime(geometryPass) + gpuProfiler.GetPassTime(lightingPass);
+            float fixedTime = std::max(gpuProfiler.GetFrameTime() - scaledTime, 0.0f);
+            // The times are from the frame that last used this slot
+            dynamicResolution.Update(fixedTime, scaledTime, renderScales[slot]);
+        }
+        renderScales[slot] = dynamicResolution.GetScale();
+        renderSize = dynamicResolution.GetRenderSize(frameSize);
+    }
+
+    // Camera and light counts for every shader of the frame
+    void SetFrameUniforms(const FrameSnapshot& frame)
+    {
+        glm::mat4 vp = frame.projection * frame.view;
+        glm::mat4 inverseVP = glm::inverse(vp);
+        for (Shader* shader : activeShaders)
+        {
+            shader->bind();
+            shader->setUniformMat4("u_vp", vp);
+            shader->setUniformMat4("u_inverseVP", inverseVP);
+            shader->setUniformFloat3("u_viewPos", frame.viewPosition);
+            shader->setUniformFloat3("u_viewDir", frame.viewDirection);
+            shader->setUniformInt("u_pointLightsNum", pointLightCount);
+            shader->setUniformInt("u_spotLightsNum", spotLightCount);
+            shader->unbind();
+        }
+    }
+
+    // Lights of the frame for the full screen lighting pass, the other modes read the point and spot lights from buffers
+    void SetLightsInShader(Shader& shader, FrameSnapshot& frame)
+    {
+        frame.directionalLight.setLightInShader("u_dirLight", shader);
+        if (lightingMode != LightingMode::FULL_SCREEN)
+            return;
+
+        const auto& pointLights = frame.lights.GetPointLights();
+        const auto& spotLights = frame.lights.GetSpotLights();
+        int pointLightsNum = std::min((int)pointLights.size(), MAX_SHADER_POINT_LIGHTS);
+        int spotLightsNum = std::min((int)spotLights.size(), MAX_SHADER_SPOT_LIGHTS);
+        shader.bind();
+        shader.setUniformInt("u_pointLightsNum", pointLightsNum);
+        shader.setUniformInt("u_spotLightsNum", spotLightsNum);
+        for (int i = 0; i < pointLightsNum; i++)
+        {
+            const auto& light = pointLights[i];
+            UniformName name("u_pointLights", i);
+            shader.setUniformFloat3(name.member("position"), glm::vec3(light.positionRange));
+            shader.setUniformFloat(name.member("constant"), light.attenuation.x);
+            shader.setUniformFloat(name.member("linear"), light.attenuation.y);
+            shader.setUniformFloat(name.member("quadratic"), light.attenuation.z);
+            shader.setUniformFloat3(name.member("ambient"), glm::vec3(light.ambient));
+            shader.setUniformFloat3(name.member("diffuse"), glm::vec3(light.diffuse));
+            shader.setUniformFloat3(name.member("specular"), glm::vec3(light.specular));
+        }
+        for (int i = 0; i < spotLightsNum; i++)
+        {
+            const auto& light = spotLights[i];
+            UniformName name("u_spotLights", i);
+            shader.setUniformFloat3(name.member("position"), glm::vec3(light.positionRange));
+            shader.setUniformFloat3(name.member("direction"), glm::vec3(light.directionCutOff));
+            shader.setUniformFloat(name.member("innerCutOff"), light.directionCutOff.w);
+            shader.setUniformFloat(name.member("outerCutOff"), light.attenuation.w);
+            shader.setUniformFloat(name.member("constant"), light.attenuation.x);
+            shader.setUniformFloat(name.member("linear"), light.attenuation.y);
+            shader.setUniformFloat(name.member("quadratic"), light.attenuation.z);
+            shader.setUniformFloat3(name.member("ambient"), glm::vec3(light.ambient));
+            shader.setUniformFloat3(name.member("diffuse"), glm::vec3(light.diffuse));
+            shader.setUniformFloat3(name.member("specular"), glm::vec3(light.specular));
+        }
+        shader.unbind();
+    }
+
+    // Points the lighting shaders at the part of the G-buffer the scaled passes wrote
+    void SetRenderScaleInShader(Shader& shader)
+    {
+        shader.bind();
+        shader.setUniformFloat2("u_uvScale", renderSize / frameSize);
+        shader.unbind();
+    }
+
+    void BindGBufferTextures(FrameGraph& graph, Shader& shader)
+    {
+        shader.bind();
+        shader.setUniformInt("gDepth", 0);
+        shader.setUniformInt("gNormal", 1);
+        shader.setUniformInt("gAlbedoSpec", 2);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, graph.GetTexture(targets.gDepth));
+        glActiveTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_2D, graph.GetTexture(targets.normal));
+        glActiveTexture(GL_TEXTURE0 + 2);
+        glBindTexture(GL_TEXTURE_2D, graph.GetTexture(targets.albedoSpec));
+        shader.unbind();
+    }
+
+    // Frustum culling through the scene's spatial index followed by software occlusion culling
+    void CullScene()
+    {
+        PROFILE_FUNCTION();
+        visibleObjects.clear();
+        mainScene->QueryFrustum(viewFrustum, visibleObjects);
+        if (!occlusionCulling)
+            return;
+
+        occlusionBuffer.Begin(projection * view);
+        for (auto gameObject : visibleObjects)
+        {
+            occlusionBuffer.AddOccluder(gameObject->GetOccluder(), gameObject->transform.GetModelMatrix());
+        }
+        {
+            PROFILE_ZONE("Occlusion rasterization");
+            occlusionBuffer.Rasterize(JobSystem::GetInstance());
+        }
+
+        // Occluders are kept, their own surface can not hide their bounds reliably after simplification
+        visibleObjects.erase(std::remove_if(visibleObjects.begin(), visibleObjects.end(), [this](GameObject* gameObject) {
+            return gameObject->GetOccluder() == nullptr && !occlusionBuffer.IsVisible(gameObject->GetWorldBounds());
+        }), visibleObjects.end());
+    }
+
+    // Records the draws of the geometry pass and of every shadow map on the worker threads, the GL passes only replay them
+    void RecordPasses(FrameSnapshot& frame)
+    {
+        PROFILE_FUNCTION();
+        JobSystem& jobSystem = JobSystem::GetInstance();
+        mainScene->RecordDraws(visibleObjects, frame.geometryCommands, jobSystem);
+        frame.geometryCommands.Sort(frame.viewPosition);
+        frame.statistics.drawCommands += frame.geometryCommands.GetSize();
+
+        for (int i = 0; i < shadowMaps.size(); i++)
+        {
+            CascadedShadowMap& shadowMap = shadowMaps[i];
+            ShadowMapCommands& commands = frame.shadowMaps[i];
+            commands.staticCasters.Clear();
+            commands.dynamicCasters.Clear();
+            commands.cascadeMask = 0;
+            if (!shadowRendering)
+                continue;
+
+            commands.cascadeMask = shadowMap.Update(view, glm::radians(mainCamera->fov), viewportSize.x / viewportSize.y,
+                                                    nearPlane, mainScene->GetStaticVersion());
+            if (commands.cascadeMask == 0)
+                continue;
+
+            commands.shadowMap = shadowMap;
+            if (shadowMap.GetStaticUpdateMask() != 0)
+                RecordShadowCasters(frame, shadowMap, shadowMap.GetStaticUpdateMask(), true, commands.staticCasters);
+            RecordShadowCasters(frame, shadowMap, commands.cascadeMask, false, commands.dynamicCasters);
+        }
+    }
+
+    // Records the casters of every cascade in the mask, each of them once for all layers
+    void RecordShadowCasters(FrameSnapshot& frame, CascadedShadowMap& shadowMap, unsigned int cascadeMask, bool staticCasters,
+                             CommandList& commands)
+    {
+        shadowCasters.clear();
+        for (int i = 0; i < shadowMap.GetCascadeCount(); i++)
+        {
+            if (!(cascadeMask & (1u << i)))
+                continue;
+
+            // The static layer outlives the current view, so it takes every caster of the cascade
+            const Frustum& receiverFrustum = staticCasters ? shadowMap.GetCasterFrustum(i) : viewFrustum;
+            mainScene->QueryShadowCasters(shadowMap.GetCasterFrustum(i), receiverFrustum, shadowMap.GetLightDirection(),
+                                          shadowMap.GetShadowDistance(i), staticCasters, shadowCasters);
+        }
+        std::sort(shadowCasters.begin(), shadowCasters.end());
+        shadowCasters.erase(std::unique(shadowCasters.begin(), shadowCasters.end()), shadowCasters.end());
+
+        mainScene->RecordShadowCasters(shadowCasters, staticCasters, commands, JobSystem::GetInstance());
+        // One list is drawn into every layer, the cascades have different light space origins and only write depth
+        commands.SortByMesh();
+        frame.statistics.shadowCasters += (int)shadowCasters.size();
+        frame.statistics.drawCommands += commands.GetSize();
+    }
+
+    // Replays the recorded casters of every shadow map whose cascades are due this frame
+    void RenderShadowMaps(FrameSnapshot& frame)
+    {
+        if (!shadowRendering)
+            return;
+
+        GpuProfiler::Scope scope(gpuProfiler, shadowPass);
+        for (int i = 0; i < frame.shadowMaps.size(); i++)
+        {
+            ShadowMapCommands& commands = frame.shadowMaps[i];
+            CascadedShadowMap& shadowMap = commands.shadowMap;
+            if (commands.cascadeMask == 0)
+                continue;
+
+            glViewport(0, 0, shadowMap.GetSize().x, shadowMap.GetSize().y);
+            glCullFace(GL_FRONT);
+            glEnable(GL_DEPTH_CLAMP);
+
+            if (shadowMap.GetStaticUpdateMask() != 0)
+            {
+                GpuProfiler::Scope staticScope(gpuProfiler, staticShadowMapPasses[i]);
+                shadowMap.bindStatic();
+                shadowMap.ClearStaticCascades();
+                shadowMap.SetShadowUniforms(shadowShader, shadowMap.GetStaticUpdateMask());
+                commands.staticCasters.Submit(shadowShader);
+            }
+
+            {
+                GpuProfiler::Scope dynamicScope(gpuProfiler, shadowMapPasses[i]);
+                shadowMap.CopyStaticCascades();
+                shadowMap.bind();
+                shadowMap.SetShadowUniforms(shadowShader, commands.cascadeMask);
+                commands.dynamicCasters.Submit(shadowShader);
+            }
+
+            glDisable(GL_DEPTH_CLAMP);
+            glCullFace(GL_BACK);
+        }
+    }
+
+    // Starts the pass that shades the scene. With a pre-pass the recorded draws lay down the depth first and the pass
+    // only shades fragments of equal depth, without one the pass writes the depth itself and is measured instead.
+    // Passes drawing through the components' own shaders, which may compute gl_Position differently or not be recorded
+    // at all, shade what is no further than the pre-pass depth and keep writing depth for the draws it does not hold.
+    void BeginScenePass(const CommandList& commands, bool componentShaders = false)
+    {
+        if (!depthPrePass.IsEnabled())
+        {
+            depthPrePass.BeginMeasure();
+            return;
+        }
+
+        {
+            GpuProfiler::Scope scope(gpuProfiler, prePass);
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            depthPrePass.BeginMeasure();
+            commands.SubmitDepth(depthPrePassShader);
+            depthPrePass.EndMeasure();
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        }
+        if (componentShaders)
+        {
+            glDepthFunc(GL_LEQUAL);
+            return;
+        }
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    void EndScenePass()
+    {
+        if (!depthPrePass.IsEnabled())
+        {
+            depthPrePass.EndMeasure();
+            return;
+        }
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+
+    // Declares the passes of the frame's rendering path, the graph derives their order and allocates their targets.
+    // The scene passes render into a corner of frame sized targets, so the render scale changes without reallocating.
+    void BuildFrameGraph(FrameSnapshot& frame)
+    {
+        frameGraph.Reset();
+        targets = FrameTargets();
+        int width = (int)frameSize.x;
+        int height = (int)frameSize.y;
+        targets.mainColor = frameGraph.Import("Main color", mainFBO.texture, {width, height, GL_RGB8});
+        // Unscaled frames render straight into the main FBO's texture
+        targets.color = renderSize == frameSize ? targets.mainColor : frameGraph.Create("Scaled color", {width, height, GL_RGB8});
+        targets.depth = frameGraph.Create("Depth", {width, height, GL_DEPTH24_STENCIL8});
+        // The shadow maps keep their static cascades across frames, so they stay owned by the renderer
+        if (shadowRendering && !frame.shadowMaps.empty())
+            targets.shadowMaps = frameGraph.Import("Shadow maps");
+
+        if (frame.renderingPath == RenderingPath::DEFERRED)
+        {
+            AddGeometryPass(frame);
+            AddShadowPass(frame);
+            AddLightingPass(frame);
+        }
+        else if (frame.renderingPath == RenderingPath::FORWARD_PLUS)
+        {
+            AddForwardPlusPasses(frame);
+            AddShadowPass(frame);
+        }
+        else
+        {
+            AddForwardPass(frame);
+        }
+
+        if (targets.color != targets.mainColor)
+            AddUpscalePass();
+    }
+
+    void AddShadowPass(FrameSnapshot& frame)
+    {
+        if (targets.shadowMaps == FrameGraph::NONE)
+            return;
+
+        frameGraph.AddPass("Shadows", [this](FrameGraph::Builder& builder) {
+            builder.Write(targets.shadowMaps);
+        }, [this, &frame](FrameGraph&) {
+            RenderShadowMaps(frame);
+        });
+    }
+
+    // Compact layout, 12 bytes per pixel:
+    //  - normal:     RG16_SNORM, octahedral encoded world space normal
+    //  - albedoSpec: RGBA8, albedo and specular intensity
+    //  - gDepth:     DEPTH24_STENCIL8, world position is reconstructed from it with the inverse view-projection
+    void AddGeometryPass(FrameSnapshot& frame)
+    {
+        int width = (int)frameSize.x;
+        int height = (int)frameSize.y;
+        targets.normal = frameGraph.Create("G-buffer normal", {width, height, GL_RG16_SNORM});
+        targets.albedoSpec = frameGraph.Create("G-buffer albedo", {width, height, GL_RGBA8});
+        targets.gDepth = frameGraph.Create("G-buffer depth", {width, height, GL_DEPTH24_STENCIL8});
+
+        frameGraph.AddPass("Geometry", [this](FrameGraph::Builder& builder) {
+            builder.Write(targets.normal);
+            builder.Write(targets.albedoSpec);
+            builder.Write(targets.gDepth);
+        }, [this, &frame](FrameGraph& graph) {
+            GpuProfiler::Scope scope(gpuProfiler, geometryPass);
+            graph.BindFramebuffer({targets.normal, targets.albedoSpec}, targets.gDepth);
+            glViewport(0, 0, renderSize.x, renderSize.y);
+
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            BeginScenePass(frame.geometryCommands);
+            frame.geometryCommands.Submit(defaultGeometryPassShader);
+            EndScenePass();
+        });
+    }
+
+    void AddLightingPass(FrameSnapshot& frame)
+    {
+        frameGraph.AddPass("Lighting", [this](FrameGraph::Builder& builder) {
+            builder.Read(targets.normal);
+            builder.Read(targets.albedoSpec);
+            builder.Read(targets.gDepth);
+            if (targets.shadowMaps != FrameGraph::NONE)
+                builder.Read(targets.shadowMaps);
+            builder.Write(targets.color);
+            // The light volumes are stencil tested against a copy of the G-buffer depth
+            if (lightingMode == LightingMode::LIGHT_VOLUMES)
+                builder.Write(targets.depth);
+        }, [this, &frame](FrameGraph& graph) {
+            GpuProfiler::Scope scope(gpuProfiler, lightingPass);
+            graph.BindFramebuffer({targets.color});
+            glViewport(0, 0, renderSize.x, renderSize.y);
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            Shader& lightingPassShader = lightingMode == LightingMode::CLUSTERED ? clusteredLightingPassShader : defaultLightingPassShader;
+            if (lightingMode == LightingMode::CLUSTERED)
+            {
+                GpuProfiler::Scope cullingScope(gpuProfiler, clusterCullingPass);
+                lightClusters.Cull(frame.lights, frame.view, frame.projection, nearPlane, farPlane);
+                lightClusters.SetClustersInShader(lightingPassShader, frame.view, renderSize);
+            }
+            BindGBufferTextures(graph, lightingPassShader);
+            SetRenderScaleInShader(lightingPassShader);
+            // The lighting pass has a single directional light
+            if (!frame.shadowMaps.empty())
+                frame.shadowMaps[0].shadowMap.SetShadowMapInShader(lightingPassShader, 3);
+            SetLightsInShader(lightingPassShader, frame);
+            if (lightingMode == LightingMode::LIGHT_VOLUMES)
+            {
+                // The full screen pass only adds the directional light, the local lights are drawn as volumes
+                lightingPassShader.bind();
+                lightingPassShader.setUniformInt("u_pointLightsNum", 0);
+                lightingPassShader.setUniformInt("u_spotLightsNum", 0);
+                lightingPassShader.unbind();
+            }
+            RenderScreenQuad(lightingPassShader);
+
+            if (lightingMode == LightingMode::LIGHT_VOLUMES)
+            {
+                GpuProfiler::Scope volumeScope(gpuProfiler, lightVolumePass);
+                RenderLightVolumes(graph, frame.lights);
+            }
+        });
+    }
+
+    // The depth pre-pass always runs, its depth gives the tile culling the depth range of every tile.
+    // The shading pass then replays the recorded draws once more and only shades the visible surface.
+    void AddForwardPlusPasses(FrameSnapshot& frame)
+    {
+        frameGraph.AddPass("Depth pre-pass", [this](FrameGraph::Builder& builder) {
+            builder.Write(targets.depth);
+        }, [this, &frame](FrameGraph& graph) {
+            GpuProfiler::Scope scope(gpuProfiler, geometryPass);
+            GpuProfiler::Scope preScope(gpuProfiler, prePass);
+            graph.BindFramebuffer({}, targets.depth);
+            glViewport(0, 0, renderSize.x, renderSize.y);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            depthPrePass.BeginMeasure();
+            frame.geometryCommands.SubmitDepth(depthPrePassShader);
+            depthPrePass.EndMeasure();
+        });
+
+        frameGraph.AddPass("Forward+", [this](FrameGraph::Builder& builder) {
+            builder.Read(targets.depth);
+            if (targets.shadowMaps != FrameGraph::NONE)
+                builder.Read(targets.shadowMaps);
+            builder.Write(targets.color);
+        }, [this, &frame](FrameGraph& graph) {
+            GpuProfiler::Scope scope(gpuProfiler, lightingPass);
+            {
+                GpuProfiler::Scope cullingScope(gpuProfiler, tileCullingPass);
+                lightTiles.Cull(frame.lights, graph.GetTexture(targets.depth), frame.view, frame.projection, renderSize);
+            }
+
+            // Tested against the pre-pass depth, which is not written again
+            graph.BindFramebuffer({targets.color}, targets.depth);
+            glViewport(0, 0, renderSize.x, renderSize.y);
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            lightTiles.SetTilesInShader(forwardPlusShader);
+            if (!frame.shadowMaps.empty())
+                frame.shadowMaps[0].shadowMap.SetShadowMapInShader(forwardPlusShader, FORWARD_SHADOW_TEXTURE_UNIT);
+            frame.directionalLight.setLightInShader("u_dirLight", forwardPlusShader);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+            frame.geometryCommands.Submit(forwardPlusShader);
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        });
+    }
+
+    void AddForwardPass(FrameSnapshot& frame)
+    {
+        frameGraph.AddPass("Forward", [this](FrameGraph::Builder& builder) {
+            builder.Write(targets.color);
+            builder.Write(targets.depth);
+        }, [this, &frame](FrameGraph& graph) {
+            // The forward path draws straight from the scene, it is only safe when Prepare and Submit run on the same thread
+            GpuProfiler::Scope scope(gpuProfiler, geometryPass);
+            graph.BindFramebuffer({targets.color}, targets.depth);
+            glViewport(0, 0, renderSize.x, renderSize.y);
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            BeginScenePass(frame.geometryCommands, true);
+            mainScene->Render(visibleObjects);
+            EndScenePass();
+        });
+    }
+
+    // Stretches the scaled frame over the main FBO so it always holds a full resolution image
+    void AddUpscalePass()
+    {
+        frameGraph.AddPass("Upscale", [this](FrameGraph::Builder& builder) {
+            builder.Read(targets.color);
+            builder.Write(targets.mainColor);
+        }, [this](FrameGraph& graph) {
+            GpuProfiler::Scope scope(gpuProfiler, upscalePass);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.GetFramebuffer({targets.color}));
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, graph.GetFramebuffer({targets.mainColor}));
+            glBlitFramebuffer(0, 0, renderSize.x, renderSize.y, 0, 0, frameSize.x, frameSize.y,
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        });
+    }
+
+    // Adds every point and spot light with a mesh enclosing its range. A stencil pass per light marks the pixels
+    // whose G-buffer surface lies inside the volume, the light pass then only shades those.
+    void RenderLightVolumes(FrameGraph& graph, const LightList& lights)
+    {
+        // The stencil pass needs the scene depth in the target framebuffer
+        unsigned int target = graph.GetFramebuffer({targets.color}, targets.depth);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.GetFramebuffer({}, targets.gDepth));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+        glBlitFramebuffer(0, 0, renderSize.x, renderSize.y, 0, 0, renderSize.x, renderSize.y,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+
+        BindGBufferTextures(graph, lightVolumeShader);
+        SetRenderScaleInShader(lightVolumeShader);
+        lightVolumeShader.bind();
+        lightVolumeShader.setUniformFloat2("u_viewportSize", renderSize);
+        lightVolumeShader.unbind();
+
+        glClear(GL_STENCIL_BUFFER_BIT);
+        glEnable(GL_STENCIL_TEST);
+        glDepthMask(GL_FALSE);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        for (auto& light : lights.GetPointLights())
+        {
+            glm::vec3 position = glm::vec3(light.positionRange);
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(light.positionRange.w));
+
+            lightVolumeShader.bind();
+            lightVolumeShader.setUniformInt("u_lightType", 0);
+            lightVolumeShader.setUniformFloat3("u_pointLight.position", position);
+            lightVolumeShader.setUniformFloat3("u_pointLight.ambient", glm::vec3(light.ambient));
+            lightVolumeShader.setUniformFloat3("u_pointLight.diffuse", glm::vec3(light.diffuse));
+            lightVolumeShader.setUniformFloat3("u_pointLight.specular", glm::vec3(light.specular));
+            lightVolumeShader.setUniformFloat("u_pointLight.constant", light.attenuation.x);
+            lightVolumeShader.setUniformFloat("u_pointLight.linear", light.attenuation.y);
+            lightVolumeShader.setUniformFloat("u_pointLight.quadratic", light.attenuation.z);
+            lightVolumeShader.unbind();
+            RenderLightVolume(sphereVolume, model);
+        }
+
+        for (auto& light : lights.GetSpotLights())
+        {
+            glm::vec3 position = glm::vec3(light.positionRange);
+            glm::vec3 direction = glm::normalize(glm::vec3(light.directionCutOff));
+            float range = light.positionRange.w;
+            float outerCutOff = light.attenuation.w;
+
+            // Wide cones are cheaper to enclose with the sphere
+            glm::mat4 model;
+            bool useCone = outerCutOff > MIN_CONE_CUT_OFF;
+            if (useCone)
+            {
+                float baseRadius = range * std::sqrt(1.0f - outerCutOff * outerCutOff) / outerCutOff;
+                glm::vec3 helper = std::abs(direction.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                glm::vec3 tangent = glm::normalize(glm::cross(helper, direction));
+                glm::vec3 bitangent = glm::cross(direction, tangent);
+                model = glm::mat4(glm::vec4(tangent * baseRadius, 0.0f), glm::vec4(bitangent * baseRadius, 0.0f),
+                                  glm::vec4(direction * range, 0.0f), glm::vec4(position, 1.0f));
+            }
+            else
+            {
+                model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(range));
+            }
+
+            lightVolumeShader.bind();
+            lightVolumeShader.setUniformInt("u_lightType", 1);
+            lightVolumeShader.setUniformFloat3("u_spotLight.position", position);
+            lightVolumeShader.setUniformFloat3("u_spotLight.direction", glm::vec3(light.directionCutOff));
+            lightVolumeShader.setUniformFloat("u_spotLight.innerCutOff", light.directionCutOff.w);
+            lightVolumeShader.setUniformFloat("u_spotLight.outerCutOff", outerCutOff);
+            lightVolumeShader.setUniformFloat3("u_spotLight.ambient", glm::vec3(light.ambient));
+            lightVolumeShader.setUniformFloat3("u_spotLight.diffuse", glm::vec3(light.diffuse));
+            lightVolumeShader.setUniformFloat3("u_spotLight.specular", glm::vec3(light.specular));
+            lightVolumeShader.setUniformFloat("u_spotLight.constant", light.attenuation.x);
+            lightVolumeShader.setUniformFloat("u_spotLight.linear", light.attenuation.y);
+            lightVolumeShader.setUniformFloat("u_spotLight.quadratic", light.attenuation.z);
+            lightVolumeShader.unbind();
+            RenderLightVolume(useCone ? coneVolume : sphereVolume, model);
+        }
+
+        glDisable(GL_STENCIL_TEST);
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+        glEnable(GL_DEPTH_TEST);
+        glCullFace(GL_BACK);
+    }
+
+    void RenderLightVolume(LightVolumeMesh& volume, const glm::mat4& model)
+    {
+        // Stencil pass: non-zero where the surface is behind the front faces but in front of the back faces
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_BLEND);
+        glStencilFunc(GL_ALWAYS, 0, 0);
+        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+        lightVolumeStencilShader.bind();
+        lightVolumeStencilShader.setUniformMat4("u_model", model);
+        volume.draw();
+        lightVolumeStencilShader.unbind();
+
+        // Light pass: back faces so the volume still shades when the camera is inside, resets the stencil it passes
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+        glEnable(GL_BLEND);
+        glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+        lightVolumeShader.bind();
+        lightVolumeShader.setUniformMat4("u_model", model);
+        volume.draw();
+        lightVolumeShader.unbind();
+    }
+
+    // Milliseconds since start, moves start to now
+    static float LapTime(std::chrono::steady_clock::time_point& start)
+    {
+        auto now = std::chrono::steady_clock::now();
+        float time = std::chrono::duration<float, std::milli>(now - start).count();
+        start = now;
+        return time;
+    }
+
     void calculateDeltaTime()
     {
         float currentFrame = glfwGetTime();
@@ -82,9 +746,25 @@ private:
     }
 
     static Renderer* instance;
+    // Main thread side, the viewport of the frame being prepared
     glm::vec2 viewportSize;
+    // Render thread side, the viewport of the frame being submitted and the part of it the scene passes render to
+    glm::vec2 frameSize;
+    glm::vec2 renderSize;
     FBO mainFBO;
-    GBuffer gBuffer;
+    FrameGraph frameGraph;
+    // Resources of the frame graph being built, the passes look them up while the graph executes
+    struct FrameTargets
+    {
+        FrameGraph::Resource mainColor = FrameGraph::NONE;
+        FrameGraph::Resource color = FrameGraph::NONE;      // The main color unless the frame is scaled
+        FrameGraph::Resource depth = FrameGraph::NONE;
+        FrameGraph::Resource normal = FrameGraph::NONE;
+        FrameGraph::Resource albedoSpec = FrameGraph::NONE;
+        FrameGraph::Resource gDepth = FrameGraph::NONE;
+        FrameGraph::Resource shadowMaps = FrameGraph::NONE;
+    };
+    FrameTargets targets;
     VAO screenQuadVAO;
     VBO screenQuadVBO;
     std::vector<Vertex> screenQuadVertices = {
@@ -96,6 +776,19 @@ private:
 
     glm::mat4 view;
     glm::mat4 projection;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+    Frustum viewFrustum;
+    OcclusionBuffer occlusionBuffer;
+    std::vector<GameObject*> visibleObjects;
+    std::vector<GameObject*> shadowCasters;
+
+    // Snapshots are used in order, the main thread prepares frames[preparedFrames] while
+    // the render thread submits frames[submittedFrames], the caller keeps them FRAMES_IN_FLIGHT apart at most
+    FrameSnapshot frames[FRAMES_IN_FLIGHT];
+    unsigned int preparedFrames = 0;
+    unsigned int submittedFrames = 0;
+    std::chrono::steady_clock::time_point frameStart;
     int pointLightCount = 0;
     int spotLightCount = 0;
 
@@ -104,16 +797,56 @@ private:
 
     Shader defaultGeometryPassShader;
     Shader defaultLightingPassShader;
+    Shader clusteredLightingPassShader;
+    Shader lightVolumeShader;
+    Shader lightVolumeStencilShader;
     Shader shadowShader;
     Shader shadowTest;
-    std::vector<Shader*> activeShaders = {&defaultLightingPassShader, &defaultGeometryPassShader, &shadowShader, &shadowTest};
-    std::vector<ShadowMap> shadowMaps = {};
+    Shader depthPrePassShader;
+    Shader forwardPlusShader;
+    std::vector<Shader*> activeShaders = {&defaultLightingPassShader, &clusteredLightingPassShader, &lightVolumeShader, &lightVolumeStencilShader, &defaultGeometryPassShader, &shadowShader, &shadowTest, &depthPrePassShader, &forwardPlusShader};
+    std::vector<CascadedShadowMap> shadowMaps = {};
+    ClusteredLighting lightClusters;
+    TiledLighting lightTiles;
+    LightVolumeMesh sphereVolume = LightVolumeMesh::Sphere();
+    LightVolumeMesh coneVolume = LightVolumeMesh::Cone();
+    // Cosine of the widest spot light drawn with a cone
+    static constexpr float MIN_CONE_CUT_OFF = 0.5f;
+    // Sizes of the light arrays in lightingPassDeferred.frag
+    static constexpr int MAX_SHADER_POINT_LIGHTS = 8;
+    static constexpr int MAX_SHADER_SPOT_LIGHTS = 8;
+    // Past the material textures Mesh::bind assigns from unit 0
+    static constexpr int FORWARD_SHADOW_TEXTURE_UNIT = 8;
+
+    GpuProfiler gpuProfiler;
+    // Profiler ids of the passes, the geometry and lighting passes follow the render scale
+    int geometryPass = gpuProfiler.GetPassId("Geometry");
+    int prePass = gpuProfiler.GetPassId("Depth pre-pass");
+    int shadowPass = gpuProfiler.GetPassId("Shadows");
+    int lightingPass = gpuProfiler.GetPassId("Lighting");
+    int clusterCullingPass = gpuProfiler.GetPassId("Cluster culling");
+    int tileCullingPass = gpuProfiler.GetPassId("Tile culling");
+    int lightVolumePass = gpuProfiler.GetPassId("Light volumes");
+    int upscalePass = gpuProfiler.GetPassId("Upscale");
+    std::vector<int> shadowMapPasses;
+    std::vector<int> staticShadowMapPasses;
+    DynamicResolution dynamicResolution;
+    DepthPrePass depthPrePass;
+    // Render scale of each frame whose GPU times are still in flight
+    float renderScales[GpuProfiler::FRAME_LATENCY] = {1.0f, 1.0f, 1.0f};
+    unsigned int renderFrame = 0;
+    unsigned int lastResultFrames = 0;
+
+    RenderStatistics statistics;
 
     float deltaTime = 0.0f;
     float lastFrameTime = 0.0f;
 
-    bool deferredRendering = true;
+    RenderingPath renderingPath = RenderingPath::DEFERRED;
+    bool submitOnRenderThread = false;
     bool shadowRendering = true;
+    bool occlusionCulling = true;
+    LightingMode lightingMode = LightingMode::CLUSTERED;
 };
 
 Renderer* Renderer::instance = nullptr;
@@ -131,118 +864,130 @@ void Renderer::Init(Camera* mainCamera, Scene* mainScene, glm::vec2& viewportSiz
     this->mainCamera = mainCamera;
     this->mainScene = mainScene;
     this->viewportSize = viewportSize;
+    frameSize = viewportSize;
+    renderSize = viewportSize;
     projection = glm::perspective(glm::radians(mainCamera->fov),
                                   viewportSize.x / viewportSize.y,
-                                  0.1f, 1000.0f);
+                                  nearPlane, farPlane);
     mainFBO.resize(viewportSize.x, viewportSize.y);
-    gBuffer.resize(viewportSize.x, viewportSize.y);
     view = mainCamera->getViewMatrix();
 }
 
+void Renderer::BeginFrame() {
+    FrameSnapshot& frame = GetPreparedFrame();
+    frame.statistics = RenderStatistics();
+    frameStart = std::chrono::steady_clock::now();
+}
+
 void Renderer::PreRender() {
+    PROFILE_FUNCTION();
     /* Camera Calculations */
     projection = glm::perspective(glm::radians(mainCamera->fov),
                                   viewportSize.x / viewportSize.y,
-                                  0.1f, 1000.0f);
+                                  nearPlane, farPlane);
     view = mainCamera->getViewMatrix();
-    glm::mat4 vp = projection * view;
+    viewFrustum = Frustum(projection * view);
+
+    FrameSnapshot& frame = GetPreparedFrame();
+    frame.viewportSize = viewportSize;
+    frame.view = view;
+    frame.projection = projection;
+    frame.viewPosition = mainCamera->position;
+    frame.viewDirection = mainCamera->getFront();
+}
 
-    if (deferredRendering)
+void Renderer::Prepare()
+{
+    PROFILE_FUNCTION();
+    FrameSnapshot& frame = GetPreparedFrame();
+    auto lapStart = std::chrono::steady_clock::now();
+    frame.statistics.simulationTime = std::chrono::duration<float, std::milli>(lapStart - frameStart).count();
+
+    // Lights submit themselves again during the scene update
+    frame.lights.Clear();
+    frame.directionalLight = FrameSnapshot().directionalLight;
     {
-        gBuffer.bind();
-        glViewport(0, 0, viewportSize.x, viewportSize.y);
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        PROFILE_ZONE("Scene update");
+        mainScene->Update();
     }
-    else if (shadowRendering)
+    frame.statistics.sceneUpdateTime = LapTime(lapStart);
+    CullScene();
+    frame.statistics.cullingTime = LapTime(lapStart);
+    frame.statistics.visibleObjects = (int)visibleObjects.size();
+
+    frame.geometryCommands.Clear();
+    frame.renderingPath = renderingPath;
+    if (renderingPath != RenderingPath::FORWARD)
     {
-//        shadowMap.bind();
-//        glViewport(0, 0, shadowMap.GetSize().x, shadowMap.GetSize().y);
-//
-//        glClear(GL_DEPTH_BUFFER_BIT);
-//        shadowMap.SetShadowUniforms(shadowShader);
+        RecordPasses(frame);
+        frame.statistics.recordTime = LapTime(lapStart);
     }
-    else
+    else if (depthPrePass.GetMode() != DepthPrePassMode::OFF)
     {
-        mainFBO.bind();
-        glViewport(0, 0, viewportSize.x, viewportSize.y);
-
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // The forward pass draws through the components, only its depth pre-pass replays recorded draws
+        mainScene->RecordDraws(visibleObjects, frame.geometryCommands, JobSystem::GetInstance());
+        frame.statistics.recordTime = LapTime(lapStart);
     }
+    preparedFrames++;
+}
 
-    for (Shader* shader : activeShaders)
-    {
-        shader->bind();
-        shader->setUniformMat4("u_vp", vp);
-        shader->setUniformFloat3("u_viewPos", mainCamera->position);
-        shader->setUniformInt("u_pointLightsNum", pointLightCount);
-        shader->setUniformInt("u_spotLightsNum", spotLightCount);
-        shader->unbind();
-    }
+void Renderer::Submit()
+{
+    PROFILE_FUNCTION();
+    FrameSnapshot& frame = frames[submittedFrames++ % FRAMES_IN_FLIGHT];
+    auto lapStart = std::chrono::steady_clock::now();
+    // Uploads and other GL work queued by the jobs of the main thread
+    JobSystem::GetInstance().RunGLJobs();
+    frameSize = frame.viewportSize;
+    UpdateRenderScale();
+    depthPrePass.BeginFrame(renderSize.x * renderSize.y);
+    SetFrameUniforms(frame);
+
+    BuildFrameGraph(frame);
+    frameGraph.Compile();
+    frameGraph.Execute();
+    mainFBO.bind();
+
+    frame.statistics.depthPrePass = frame.renderingPath == RenderingPath::FORWARD_PLUS || depthPrePass.IsEnabled();
+    frame.statistics.overdraw = depthPrePass.GetOverdraw();
+    frame.statistics.renderPasses = frameGraph.GetExecutedPassCount();
+    frame.statistics.culledPasses = frameGraph.GetCulledPassCount();
+    frame.statistics.renderTargetMemory = (float)frameGraph.GetPool().GetAllocatedBytes() / (1024.0f * 1024.0f);
+    frame.statistics.submitTime = LapTime(lapStart);
+    statistics = frame.statistics;
 }
 
 void Renderer::Render()
 {
-    mainScene->Update();
-
-    if (deferredRendering)
-    {
-        gBuffer.bind();
-        glViewport(0, 0, viewportSize.x, viewportSize.y);
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        mainScene->RenderWithShader(defaultGeometryPassShader);
-
-        if (shadowRendering)
-        {
-            for (auto& shadowMap : shadowMaps)
-            {
-                shadowMap.bind();
-                glViewport(0, 0, shadowMap.GetSize().x, shadowMap.GetSize().y);
-
-                glClear(GL_DEPTH_BUFFER_BIT);
-                glCullFace(GL_FRONT);
-                shadowMap.SetShadowUniforms(shadowShader);
-                mainScene->RenderWithShader(shadowShader);
-                glCullFace(GL_BACK);
-            }
-        }
-
-        mainFBO.bind();
-        glViewport(0, 0, viewportSize.x, viewportSize.y);
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        gBuffer.BindTextures(defaultLightingPassShader);
-        for (int i = 0; i < shadowMaps.size(); i++)
-        {
-            shadowMaps[i].SetShadowUniforms(defaultLightingPassShader, i);
-            shadowMaps[i].SetShadowMapInShader(defaultLightingPassShader, i);
-        }
-        mainScene->RenderLightsOnly(defaultLightingPassShader);
-        RenderScreenQuad(defaultLightingPassShader);
-    }
-    else
-    {
-        mainFBO.bind();
-        mainScene->Render();
-    }
+    Prepare();
+    Submit();
 }
 
 void Renderer::PostRender() {
+    PROFILE_FUNCTION();
     //mainFBO.unbind();
     calculateDeltaTime();
 }
 
 void Renderer::DrawToWindow(Window& window) {
+    // Headless windows have no default framebuffer, the frame stays in the main FBO
+    if (window.IsHeadless())
+        return;
+
     glBindFramebuffer(GL_READ_FRAMEBUFFER, mainFBO.ID);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, viewportSize.x, viewportSize.y, 0, 0, window.GetWidth(), window.GetHeight(),
+    glBlitFramebuffer(0, 0, frameSize.x, frameSize.y, 0, 0, window.GetWidth(), window.GetHeight(),
                       GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
+void Renderer::ReadFrame(std::vector<unsigned char>& pixels) {
+    pixels.resize((size_t)frameSize.x * (size_t)frameSize.y * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, mainFBO.ID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, frameSize.x, frameSize.y, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
 void Renderer::SetViewportSize(glm::vec2& viewportSize) {
     this->viewportSize = viewportSize;
 }
@@ -250,8 +995,13 @@ void Renderer::SetViewportSize(glm::vec2& viewportSize) {
 Renderer::Renderer() : mainFBO(1280, 720), screenQuadVBO(screenQuadVertices),
                        defaultGeometryPassShader("./resources/shaders/geometryPassDeferred.vert", "./resources/shaders/geometryPassDeferred.frag"),
                        defaultLightingPassShader("./resources/shaders/lightingPassDeferred.vert", "./resources/shaders/lightingPassDeferred.frag"),
-                       shadowShader("./resources/shaders/shadow.vert", "./resources/shaders/shadow.frag"),
-                       shadowTest("./resources/shaders/lightingPassDeferred.vert", "./resources/shaders/shadowTest.frag")
+                       clusteredLightingPassShader("./resources/shaders/lightingPassDeferred.vert", "./resources/shaders/lightingPassClustered.frag"),
+                       lightVolumeShader("./resources/shaders/lightVolume.vert", "./resources/shaders/lightVolume.frag"),
+                       lightVolumeStencilShader("./resources/shaders/lightVolume.vert", "./resources/shaders/lightVolumeStencil.frag"),
+                       shadowShader("./resources/shaders/shadowCascades.vert", "./resources/shaders/shadowCascades.geom", "./resources/shaders/shadow.frag"),
+                       shadowTest("./resources/shaders/lightingPassDeferred.vert", "./resources/shaders/shadowTest.frag"),
+                       depthPrePassShader("./resources/shaders/depthPrePass.vert", "./resources/shaders/depthPrePass.frag"),
+                       forwardPlusShader("./resources/shaders/geometryPassDeferred.vert", "./resources/shaders/forwardPlus.frag")
 {
     InitScreenQuad();
 };
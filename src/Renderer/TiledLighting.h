@@ -0,0 +1,90 @@
+#ifndef OPENGL_GAMEENGINE_TILEDLIGHTING_H
+#define OPENGL_GAMEENGINE_TILEDLIGHTING_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Engine/SSBO.hpp"
+#include "Engine/shader.hpp"
+#include "Renderer/ClusteredLighting.h"
+
+// Light lists of the Forward+ path. The render area is split into screen space tiles, a compute shader reduces the depth
+// pre-pass to the depth range of each tile and keeps the point and spot lights whose range reaches into it. The light
+// grid has the layout of the clustered one, one entry per tile instead of per cluster.
+class TiledLighting
+{
+public:
+    static constexpr unsigned int TILE_SIZE = 16;
+    // Average number of lights per tile the index list starts with room for, it grows to what the tiles use
+    static constexpr unsigned int AVERAGE_TILE_LIGHTS = 64;
+    // Matches MAX_TILE_LIGHTS in tileCulling.comp
+    static constexpr unsigned int MAX_TILE_LIGHTS = 256;
+
+    TiledLighting() : cullingShader("./resources/shaders/tileCulling.comp"), lightIndices("TiledLighting", MAX_TILE_LIGHTS) {}
+
+    // Uploads the lights and builds the per tile light lists from the depth texture of the render area
+    void Cull(const LightList& lights, unsigned int depthTexture, const glm::mat4& view, const glm::mat4& projection,
+              const glm::vec2& renderSize)
+    {
+        const std::vector<LightList::GpuPointLight>& pointLights = lights.GetPointLights();
+        const std::vector<LightList::GpuSpotLight>& spotLights = lights.GetSpotLights();
+        renderArea = glm::uvec2(renderSize);
+        tileCount = (renderArea + TILE_SIZE - 1u) / TILE_SIZE;
+        unsigned int tiles = tileCount.x * tileCount.y;
+        // Grows with the render size and stays at the largest one
+        lightGrid.Reserve(tiles * sizeof(glm::uvec4));
+
+        pointLightBuffer.SetData(pointLights.data(), pointLights.size() * sizeof(LightList::GpuPointLight));
+        spotLightBuffer.SetData(spotLights.data(), spotLights.size() * sizeof(LightList::GpuSpotLight));
+        lightIndices.Prepare(tiles, (unsigned int)(pointLights.size() + spotLights.size()), AVERAGE_TILE_LIGHTS);
+        BindBuffers();
+        lightIndices.BindCounter(4);
+
+        cullingShader.bind();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        cullingShader.setUniformInt("u_depth", 0);
+        cullingShader.setUniformMat4("u_view", view);
+        cullingShader.setUniformMat4("u_inverseProjection", glm::inverse(projection));
+        cullingShader.setUniformUInt2("u_renderSize", renderArea);
+        cullingShader.setUniformUInt2("u_tileCount", tileCount);
+        cullingShader.setUniformInt("u_pointLightsNum", (int)pointLights.size());
+        cullingShader.setUniformInt("u_spotLightsNum", (int)spotLights.size());
+        cullingShader.setUniformUInt("u_lightIndexCapacity", lightIndices.GetCapacity());
+        cullingShader.dispatch(tileCount.x, tileCount.y);
+        cullingShader.unbind();
+        lightIndices.EndDispatch();
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // Binds the light lists for the forward shading pass and sets the tile lookup uniforms
+    void SetTilesInShader(Shader& shader)
+    {
+        BindBuffers();
+        shader.bind();
+        shader.setUniformUInt2("u_tileCount", tileCount);
+        shader.setUniformUInt("u_tileSize", TILE_SIZE);
+        shader.unbind();
+    }
+
+    glm::uvec2 GetTileCount() const { return tileCount; }
+
+private:
+    void BindBuffers()
+    {
+        pointLightBuffer.bindBase(0);
+        spotLightBuffer.bindBase(1);
+        lightGrid.bindBase(2);
+        lightIndices.BindIndices(3);
+    }
+
+    Shader cullingShader;
+    SSBO pointLightBuffer;
+    SSBO spotLightBuffer;
+    SSBO lightGrid;
+    LightIndexList lightIndices;
+    glm::uvec2 renderArea = glm::uvec2(0);
+    glm::uvec2 tileCount = glm::uvec2(0);
+};
+
+#endif //OPENGL_GAMEENGINE_TILEDLIGHTING_H
@@ -1,18 +1,21 @@
 #include "Window/Window.h"
-#include <iostream>
+#include "Engine/Log.hpp"
+
+#include <cstdlib>
 
 Window* Window::_instance = nullptr;
 
-Window::Window(std::string title, unsigned int windowWidth, unsigned int windowHeight)
+Window::Window(std::string title, unsigned int windowWidth, unsigned int windowHeight, bool headless)
 {
     if (_instance)
     {
-        std::cout<<"Window already exists!"<<std::endl;
+        LOG_ERROR("Window", "Window already exists!");
     }
     _instance = this;
     _title = title;
     _windowWidth = windowWidth;
     _windowHeight = windowHeight;
+    _headless = headless;
     _openglContext = OpenGLContext();
 
     Init();
@@ -20,18 +23,31 @@ Window::Window(std::string title, unsigned int windowWidth, unsigned int windowH
 
 void Window::Init()
 {
+#ifdef GLFW_PLATFORM_NULL
+    // No display server is needed, the context comes from EGL or OSMesa
+    if (_headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
     if (!glfwInit())
-        std::cout<<"Failed to initialize GLFW!"<<std::endl;
+    {
+        LOG_ERROR("Window", "Failed to initialize GLFW!");
+        std::exit(EXIT_FAILURE);
+    }
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, _openglContext.GetMajorVersion());
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, _openglContext.GetMinorVersion());
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    _glfwWindow = glfwCreateWindow((int)_windowWidth, (int)_windowHeight, _title.c_str(), nullptr, nullptr);
+    if (_headless)
+        _glfwWindow = CreateHeadlessWindow();
+    else
+        _glfwWindow = glfwCreateWindow((int)_windowWidth, (int)_windowHeight, _title.c_str(), nullptr, nullptr);
     if (!_glfwWindow)
     {
-        std::cout << "Failed to create GLFW window!" << std::endl;
+        // Nothing works without a context, the error is written before exiting
+        LOG_ERROR("Window", "Failed to create GLFW window!");
         glfwTerminate();
+        std::exit(EXIT_FAILURE);
     }
 
     _openglContext.Init(_glfwWindow);
@@ -44,10 +60,40 @@ void Window::SetupCallbacks()
 
 }
 
+// Tries a surfaceless EGL context first and falls back to OSMesa, both run on Mesa's software rasterizer
+GLFWwindow* Window::CreateHeadlessWindow()
+{
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    for (int contextApi : {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API})
+    {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+        GLFWwindow* glfwWindow = glfwCreateWindow((int)_windowWidth, (int)_windowHeight, _title.c_str(), nullptr, nullptr);
+        if (glfwWindow)
+            return glfwWindow;
+    }
+
+    LOG_ERROR("Window", "Failed to create a headless OpenGL %d.%d context! With Mesa, GALLIUM_DRIVER=zink on lavapipe provides it in software.",
+              _openglContext.GetMajorVersion(), _openglContext.GetMinorVersion());
+    return nullptr;
+}
+
 void Window::OnUpdate()
+{
+    PollEvents();
+    SwapBuffers();
+}
+
+void Window::SwapBuffers()
+{
+    // Headless frames stay in the renderer's framebuffers
+    if (!_headless)
+        _openglContext.SwapBuffers();
+}
+
+void Window::PollEvents()
 {
     glfwPollEvents();
-    _openglContext.SwapBuffers();
 }
 
 void Window::Shutdown()
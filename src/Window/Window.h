@@ -9,9 +9,14 @@
 
 class Window {
 public:
-    Window(std::string title, unsigned int windowWidth, unsigned int windowHeight);
+    // A headless window has no display, its context is created offscreen and nothing is presented
+    Window(std::string title, unsigned int windowWidth, unsigned int windowHeight, bool headless = false);
 
+    // Polls the events and presents the frame
     void OnUpdate();
+    // Presenting has to run on the thread the context is current on, polling on the main thread
+    void SwapBuffers();
+    void PollEvents();
     bool IsAlive();
     void Shutdown();
 
@@ -20,6 +25,8 @@ public:
     void SetHeight(unsigned int newHeight) { _windowHeight = newHeight; }
     unsigned int GetHeight() const { return _windowHeight; }
 
+    bool IsHeadless() const { return _headless; }
+
     GLFWwindow* GetGLFWWindow() { return _glfwWindow; }
 
     static Window& GetInstance() {return *_instance; };
@@ -27,11 +34,13 @@ public:
 private:
     void Init();
     void SetupCallbacks();
+    GLFWwindow* CreateHeadlessWindow();
 
     std::string _title;
 
     unsigned int _windowWidth = 1280;
     unsigned int _windowHeight = 720;
+    bool _headless = false;
 
     GLFWwindow* _glfwWindow;
     OpenGLContext _openglContext;
@@ -16,6 +16,10 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
 
 #include "Engine/FBO.hpp"
 #include "Engine/shader.hpp"
@@ -26,6 +30,9 @@
 #include "Engine/light.hpp"
 #include "Engine/model.hpp"
 #include "Engine/modelLoader.hpp"
+#include "Engine/Profiler.hpp"
+#include "Engine/Log.hpp"
+#include "Engine/CameraPath.hpp"
 
 #include "Window/Window.h"
 #include "Gui/EditorGui.h"
@@ -35,12 +42,25 @@
 #include "GameObject/GameObject.hpp"
 #include "EventHandler/EventHandler.h"
 #include "Core/Application.h"
+#include "Core/FrameStatistics.h"
 #include "GameObject/Scene.hpp"
 #include "GameObject/GameObject.hpp"
 #include "GameComponent/GameComponent.hpp"
 #include "GameComponent/ModelRenderer.hpp"
 #include "GameComponent/LightRenderer.hpp"
 
+// Command line options of a headless benchmark run
+struct HeadlessSettings
+{
+    bool enabled = false;
+    int frames = 600;
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    std::string statsPath = "headless_stats.json";
+    std::string dumpDirectory = "";
+    int dumpInterval = 0;   // Writes every n-th frame as an image when non-zero
+};
+
 class MyApplication : public Application{
 public:
     float lastX;
@@ -71,8 +91,15 @@ public:
 
     std::vector<GameObject*> shibas;
 
-    MyApplication(Window& window) : Application(window), camera(glm::vec3(0.0f, 0.0f, 3.0f)),
-    shader("./resources/shaders/standardShader.vert", "./resources/shaders/standardShader.frag")
+    HeadlessSettings headless;
+    CameraPath headlessPath;
+    FrameStatistics headlessStatistics;
+    int headlessFrame = 0;
+    unsigned int lastGpuResultFrames = 0;
+    std::chrono::steady_clock::time_point frameStart;
+
+    MyApplication(Window& window, HeadlessSettings headless = HeadlessSettings()) : Application(window), camera(glm::vec3(0.0f, 0.0f, 3.0f)),
+    shader("./resources/shaders/standardShader.vert", "./resources/shaders/standardShader.frag"), headless(headless)
     {
         lastX = (float)window.GetWidth() / 2;
         lastY = (float)window.GetHeight() / 2;
@@ -92,7 +119,6 @@ public:
         if (!guiOn)
         {
             sceneFBO.resize(window.GetWidth(), window.GetHeight());
-            renderer->GetGBuffer().resize(window.GetWidth(), window.GetHeight());
         }
     }
 
@@ -170,6 +196,25 @@ public:
         {
             shibaMove = !shibaMove;
         }
+        if (key == GLFW_KEY_O && action == GLFW_PRESS)
+        {
+            if (!Profiler::IsCapturing())
+            {
+                Profiler::BeginCapture();
+                LOG_INFO("Profiler", "CPU capture started");
+            }
+            else
+            {
+                Profiler::EndCapture();
+                if (Profiler::ExportChromeTrace("cpu_trace.json"))
+                    LOG_INFO("Profiler", "CPU trace written to cpu_trace.json");
+            }
+        }
+        if (key == GLFW_KEY_P && action == GLFW_PRESS)
+        {
+            if (renderer->GetGpuProfiler().ExportHistory("gpu_profile.csv"))
+                LOG_INFO("Profiler", "GPU profile written to gpu_profile.csv");
+        }
     }
 
     void gui_key_callback(GLFWwindow* glfwWindow, int key, int scancode, int action, int mods)
@@ -181,8 +226,7 @@ public:
             if (!guiOn)
             {
                 sceneFBO.resize(window.GetWidth(), window.GetHeight());
-                renderer->GetGBuffer().resize(window.GetWidth(), window.GetHeight());
-                std::cout<<window.GetWidth()<<" "<<window.GetHeight()<<std::endl;
+                LOG_DEBUG("Editor", "Scene resized to %u x %u", window.GetWidth(), window.GetHeight());
                 sceneWindow->Disable();
             }
         }
@@ -220,8 +264,7 @@ public:
         for (int i = 0; i < 30; i++)
         {
             GameObject* shiba = scene.CreateGameObject();
-            ModelRenderer* modelRenderer = new ModelRenderer(shibaModel, shader);
-            shiba->AddComponent(modelRenderer);
+            shiba->AddComponent<ModelRenderer>(shibaModel, shader);
             shiba->SetRotation(glm::quat(glm::vec3(0.0f, 0.0f, glm::radians(90.0f))));
             shiba->SetPosition(glm::vec3( -50.0f + i * 3.0f, 0.0f, 0.0f));
             shibas.push_back(shiba);
@@ -229,9 +272,10 @@ public:
 
         GameObject* baseTerrain = scene.CreateGameObject();
         Model* baseTerrainModel = ModelLoader::LoadModel("./resources/models/base_terrain/base_terrain.obj");
-        ModelRenderer* baseTerrainModelRenderer = new ModelRenderer(baseTerrainModel, shader);
-        baseTerrain->AddComponent(baseTerrainModelRenderer);
+        baseTerrainModel->buildOccluder(32);
+        baseTerrain->AddComponent<ModelRenderer>(baseTerrainModel, shader);
         baseTerrain->SetPosition(glm::vec3(0.0f, -1.0f, 0.0f));
+        baseTerrain->SetStatic(true);
         
         std::vector<glm::vec3> treePositions = {
             glm::vec3(7.0f, -1.0f,  20.0f),
@@ -251,26 +295,32 @@ public:
         };
 
         Model* treeModel = ModelLoader::LoadModel("./resources/models/tree/tree.obj");
-        ModelRenderer* treeModelRenderer = new ModelRenderer(treeModel, shader);
+        // Opaque trunk and closed canopies, the occluder stays inside them
+        treeModel->buildOccluder();
         for (auto& position : treePositions)
         {
             GameObject* tree = scene.CreateGameObject();
-            tree->AddComponent(treeModelRenderer);
+            tree->AddComponent<ModelRenderer>(treeModel, shader);
             tree->SetPosition(position);
+            tree->SetStatic(true);
         }
         
         GameObject* directionalLight = scene.CreateGameObject();
         GameObject* spotLightObject = scene.CreateGameObject();
-        DirectionalLightRenderer* dirLightRenderer = new DirectionalLightRenderer(dirLight, shader);
-        spotLightRenderer = new SpotLightRenderer(spotLight, shader);
-        directionalLight->AddComponent(dirLightRenderer);
-        spotLightObject->AddComponent(spotLightRenderer);
+        directionalLight->AddComponent<DirectionalLightRenderer>(dirLight, shader);
+        spotLightRenderer = spotLightObject->AddComponent<SpotLightRenderer>(spotLight, shader);
         spotLightRenderer->Disable();
 
         /// Renderer
         glm::vec2 viewPortSize = glm::vec2(window.GetWidth(), window.GetHeight());
         renderer->Init(&camera, &scene, viewPortSize);
 
+        if (headless.enabled)
+        {
+            headlessPath = CameraPath::Orbit(glm::vec3(0.0f, 0.0f, 0.0f), 60.0f, 5.0f, 25.0f);
+            return;
+        }
+
         /// SETUP IMGUI
         editorGui = new EditorGui(window);
         sceneWindow = new SceneWidget(sceneFBO, baseTerrain, renderer->GetView(), renderer->GetProjection());
@@ -293,7 +343,15 @@ public:
             glm::vec2 viewport = glm::vec2(window.GetWidth(), window.GetHeight());
             renderer->SetViewportSize(viewport);
         }
-        processInput(window.GetGLFWWindow());
+        if (headless.enabled)
+        {
+            headlessPath.Apply(camera, (float)headlessFrame / headless.frames);
+            frameStart = std::chrono::steady_clock::now();
+        }
+        else
+        {
+            processInput(window.GetGLFWWindow());
+        }
         renderer->PreRender();
     }
 
@@ -304,8 +362,8 @@ public:
             for (int i = 0; i < shibas.size(); i++)
             {
                 glm::mat4 sinTranslation = glm::mat4(1.0f);
-                sinTranslation = glm::translate(sinTranslation, glm::vec3(0.0f, 0.0f, glm::sin(float(glfwGetTime()) - float(i)) * 10.0f));
-                shibas[i]->transform.CalculateModelMatrix(sinTranslation);
+                sinTranslation = glm::translate(sinTranslation, glm::vec3(0.0f, 0.0f, glm::sin(GetAnimationTime() - float(i)) * 10.0f));
+                shibas[i]->CalculateModelMatrix(sinTranslation);
             }
         }
 
@@ -322,6 +380,7 @@ public:
         /// POST RENDER
         if (guiOn)
         {
+            PROFILE_ZONE("ImGui");
             editorGui->Begin();
             editorGui->Render();
             editorGui->End();
@@ -331,14 +390,110 @@ public:
             renderer->DrawToWindow(window);
         }
 
-        std::cout<<1.0f / renderer->GetDeltaTime()<<std::endl;
+        if (headless.enabled)
+            EndHeadlessFrame();
+        else
+            LOG_DEBUG("App", "%.1f fps", 1.0f / renderer->GetDeltaTime());
+    }
+
+    // Headless runs step the animation by a fixed 60 Hz so every run renders the same frames
+    float GetAnimationTime()
+    {
+        return headless.enabled ? headlessFrame / 60.0f : float(glfwGetTime());
+    }
+
+    void EndHeadlessFrame()
+    {
+        // Waits for the GPU so the frame time covers the whole frame, nothing is presented to pace it
+        glFinish();
+        auto frameEnd = std::chrono::steady_clock::now();
+        headlessStatistics.Add("frame", std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+
+        GpuProfiler& gpuProfiler = renderer->GetGpuProfiler();
+        if (gpuProfiler.GetResultFrames() != lastGpuResultFrames)
+        {
+            lastGpuResultFrames = gpuProfiler.GetResultFrames();
+            headlessStatistics.Add("gpu", gpuProfiler.GetFrameTime());
+            for (int pass = 0; pass < gpuProfiler.GetPassCount(); pass++)
+                headlessStatistics.Add("gpu/" + gpuProfiler.GetPassName(pass), gpuProfiler.GetPassTime(pass));
+        }
+
+        if (headless.dumpInterval > 0 && headlessFrame % headless.dumpInterval == 0)
+            DumpFrame(headless.dumpDirectory + "/frame_" + std::to_string(headlessFrame) + ".ppm");
+
+        if (++headlessFrame >= headless.frames)
+        {
+            nlohmann::json run = {
+                    {"frames", headless.frames},
+                    {"width", headless.width},
+                    {"height", headless.height},
+                    {"renderer", (const char*)glGetString(GL_RENDERER)},
+                    {"version", (const char*)glGetString(GL_VERSION)}
+            };
+            if (headlessStatistics.WriteJson(headless.statsPath, run))
+                LOG_INFO("Headless", "Frame statistics written to %s", headless.statsPath.c_str());
+            glfwSetWindowShouldClose(window.GetGLFWWindow(), true);
+        }
+    }
+
+    // Binary PPM, needs no image library
+    void DumpFrame(const std::string& path)
+    {
+        std::vector<unsigned char> pixels;
+        renderer->ReadFrame(pixels);
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Headless", "Failed to write frame %s", path.c_str());
+            return;
+        }
+        file << "P6\n" << headless.width << " " << headless.height << "\n255\n";
+        // GL rows start at the bottom
+        size_t rowSize = (size_t)headless.width * 3;
+        for (int row = (int)headless.height - 1; row >= 0; row--)
+            file.write((const char*)pixels.data() + row * rowSize, rowSize);
     }
 };
 
-int main()
+// --headless [--frames n] [--width w] [--height h] [--stats file.json] [--dump directory] [--dump-interval n]
+HeadlessSettings ParseHeadlessSettings(int argc, char** argv)
+{
+    HeadlessSettings settings;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0)
+            settings.enabled = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            settings.frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--width") == 0 && hasValue)
+            settings.width = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--height") == 0 && hasValue)
+            settings.height = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--stats") == 0 && hasValue)
+            settings.statsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--dump") == 0 && hasValue)
+        {
+            settings.dumpDirectory = argv[++i];
+            if (settings.dumpInterval == 0)
+                settings.dumpInterval = 60;
+        }
+        else if (std::strcmp(argv[i], "--dump-interval") == 0 && hasValue)
+            settings.dumpInterval = std::max(0, std::atoi(argv[++i]));
+        else
+            LOG_WARNING("App", "Unknown argument: %s", argv[i]);
+    }
+    if (settings.dumpInterval > 0 && settings.dumpDirectory.empty())
+        settings.dumpDirectory = ".";
+    return settings;
+}
+
+int main(int argc, char** argv)
 {
-    Window window("OpenGL Engine", 1280, 720);
-    MyApplication myApp(window);
+    HeadlessSettings headless = ParseHeadlessSettings(argc, argv);
+    Window window("OpenGL Engine", headless.width, headless.height, headless.enabled);
+    MyApplication myApp(window, headless);
     myApp.Run();
     return 0;
 }
@@ -0,0 +1,209 @@
+#include <vector>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Engine/OcclusionBuffer.hpp"
+#include "Engine/OccluderMesh.hpp"
+#include "Engine/JobSystem.hpp"
+#include "Engine/Log.hpp"
+
+// Checks of the CPU occlusion culling: the rasterized depth, the visibility test against it and that simplified
+// occluders stay inside the surface they stand in for. Runs without a GL context, returns non-zero on a failure.
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { if (!(condition)) { LOG_ERROR("OcclusionTest", "%s:%d: %s", __FILE__, __LINE__, #condition); failures++; } } while (false)
+
+struct TestVertex
+{
+    glm::vec3 position;
+};
+
+struct TestMesh
+{
+    std::vector<TestVertex> vertices;
+    std::vector<unsigned int> indices;
+
+    AABB GetBounds() const
+    {
+        AABB bounds;
+        for (auto& vertex : vertices)
+            bounds.Extend(vertex.position);
+        return bounds;
+    }
+};
+
+// Counter-clockwise seen from above, like the terrain
+TestMesh MakeHeightField(int resolution, float size, float (*height)(float, float))
+{
+    TestMesh mesh;
+    for (int z = 0; z <= resolution; z++)
+    {
+        for (int x = 0; x <= resolution; x++)
+        {
+            float px = (x / (float)resolution - 0.5f) * size;
+            float pz = (z / (float)resolution - 0.5f) * size;
+            mesh.vertices.push_back({glm::vec3(px, height(px, pz), pz)});
+        }
+    }
+    for (int z = 0; z < resolution; z++)
+    {
+        for (int x = 0; x < resolution; x++)
+        {
+            unsigned int current = z * (resolution + 1) + x;
+            unsigned int below = current + resolution + 1;
+            mesh.indices.insert(mesh.indices.end(), {current, below, current + 1, current + 1, below, below + 1});
+        }
+    }
+    return mesh;
+}
+
+float Ridge(float x, float z)
+{
+    return 4.0f - std::abs(x) - 0.5f * std::abs(z);
+}
+
+float Waves(float x, float z)
+{
+    return std::sin(x * 1.3f) + std::cos(z * 0.7f);
+}
+
+// Every point of the occluder's triangles must be on or under the height field
+void CheckUnderHeightField(const OccluderMesh& occluder, float (*height)(float, float))
+{
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+    {
+        const glm::vec3& a = occluder.vertices[occluder.indices[i]];
+        const glm::vec3& b = occluder.vertices[occluder.indices[i + 1]];
+        const glm::vec3& c = occluder.vertices[occluder.indices[i + 2]];
+        for (float u = 0.0f; u <= 1.0f; u += 0.125f)
+        {
+            for (float v = 0.0f; u + v <= 1.0f; v += 0.125f)
+            {
+                glm::vec3 point = a + (b - a) * u + (c - a) * v;
+                CHECK(point.y <= height(point.x, point.z) + 1e-4f);
+            }
+        }
+    }
+}
+
+void TestSimplifyStaysUnderSurface()
+{
+    for (auto height : {Ridge, Waves})
+    {
+        std::vector<TestMesh> meshes = {MakeHeightField(64, 16.0f, height)};
+        for (int resolution : {4, 8, 16})
+        {
+            OccluderMesh occluder = OccluderMesh::Simplify(meshes, meshes[0].GetBounds(), resolution);
+            CHECK(occluder.GetTriangleCount() > 0);
+            CHECK(occluder.GetTriangleCount() < meshes[0].indices.size() / 3);
+            CheckUnderHeightField(occluder, height);
+        }
+    }
+}
+
+void TestSimplifyStaysInsideSphere()
+{
+    // Counter-clockwise seen from outside
+    TestMesh sphere;
+    const int rings = 24;
+    const int segments = 32;
+    for (int ring = 0; ring <= rings; ring++)
+    {
+        float phi = glm::pi<float>() * ring / rings;
+        for (int segment = 0; segment <= segments; segment++)
+        {
+            float theta = 2.0f * glm::pi<float>() * segment / segments;
+            sphere.vertices.push_back({glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta))});
+        }
+    }
+    for (int ring = 0; ring < rings; ring++)
+    {
+        for (int segment = 0; segment < segments; segment++)
+        {
+            unsigned int current = ring * (segments + 1) + segment;
+            unsigned int below = current + segments + 1;
+            sphere.indices.insert(sphere.indices.end(), {current, current + 1, below, current + 1, below + 1, below});
+        }
+    }
+
+    std::vector<TestMesh> meshes = {sphere};
+    OccluderMesh occluder = OccluderMesh::Simplify(meshes, sphere.GetBounds(), 6);
+    CHECK(occluder.GetTriangleCount() > 0);
+    for (auto& vertex : occluder.vertices)
+        CHECK(glm::length(vertex) <= 1.0f);
+}
+
+// Both sides of a wall fall into the same cells, the occluder can not tell where the inside is and drops them
+void TestSimplifyDropsTwoSidedSurfaces()
+{
+    TestMesh wall;
+    wall.vertices = {{glm::vec3(-1.0f, 0.0f, 0.0f)}, {glm::vec3(1.0f, 0.0f, 0.0f)}, {glm::vec3(1.0f, 2.0f, 0.0f)},
+                     {glm::vec3(-1.0f, 2.0f, 0.0f)}};
+    wall.indices = {0, 1, 2, 0, 2, 3, 0, 2, 1, 0, 3, 2};
+
+    std::vector<TestMesh> meshes = {wall};
+    OccluderMesh occluder = OccluderMesh::Simplify(meshes, wall.GetBounds(), 1);
+    CHECK(occluder.GetTriangleCount() == 0);
+}
+
+// A wall of two triangles 10 units in front of the camera, covering the middle of the screen
+void TestRasterizedVisibility(JobSystem& jobSystem)
+{
+    OccluderMesh wall;
+    wall.vertices = {glm::vec3(-4.0f, -4.0f, -10.0f), glm::vec3(4.0f, -4.0f, -10.0f), glm::vec3(4.0f, 4.0f, -10.0f),
+                     glm::vec3(-4.0f, 4.0f, -10.0f)};
+    wall.indices = {0, 1, 2, 0, 2, 3};
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    OcclusionBuffer buffer(256, 128);
+    buffer.Begin(projection * view);
+    buffer.AddOccluder(&wall, glm::mat4(1.0f));
+    buffer.Rasterize(jobSystem);
+    FrameAllocator::GetInstance().Reset();
+
+    CHECK(buffer.GetStatistics().triangles == 2);
+    // The wall's depth in the middle of the screen, the corners stay cleared
+    float wallDepth = buffer.GetDepth()[64 * buffer.GetWidth() + 128];
+    CHECK(wallDepth < 1.0f);
+    CHECK(buffer.GetDepth()[0] == 1.0f);
+
+    // Behind the wall and inside its outline
+    CHECK(!buffer.IsVisible(AABB(glm::vec3(-1.0f, -1.0f, -21.0f), glm::vec3(1.0f, 1.0f, -19.0f))));
+    // In front of the wall
+    CHECK(buffer.IsVisible(AABB(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -5.0f))));
+    // Reaching through the wall
+    CHECK(buffer.IsVisible(AABB(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -8.0f))));
+    // Behind the wall but sticking out past its edge
+    CHECK(buffer.IsVisible(AABB(glm::vec3(3.0f, -1.0f, -21.0f), glm::vec3(12.0f, 1.0f, -19.0f))));
+    // Beside the wall
+    CHECK(buffer.IsVisible(AABB(glm::vec3(10.0f, -1.0f, -21.0f), glm::vec3(12.0f, 1.0f, -19.0f))));
+    // Crossing the near plane
+    CHECK(buffer.IsVisible(AABB(glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f))));
+    CHECK(buffer.GetStatistics().testedObjects == 6);
+    CHECK(buffer.GetStatistics().occludedObjects == 1);
+
+    // Nothing hides anything without occluders
+    buffer.Begin(projection * view);
+    buffer.Rasterize(jobSystem);
+    CHECK(buffer.IsVisible(AABB(glm::vec3(-1.0f, -1.0f, -21.0f), glm::vec3(1.0f, 1.0f, -19.0f))));
+}
+
+int main()
+{
+    JobSystem jobSystem(2);
+    TestSimplifyStaysUnderSurface();
+    TestSimplifyStaysInsideSphere();
+    TestSimplifyDropsTwoSidedSurfaces();
+    TestRasterizedVisibility(jobSystem);
+
+    if (failures == 0)
+        LOG_INFO("OcclusionTest", "All checks passed");
+    Log::Flush();
+    return failures == 0 ? 0 : 1;
+}